@@ -51,10 +51,23 @@ public:
   u8** ptr;
   Mode mode;
 
+  // Optional size of the buffer for MODE_WRITE. A write that doesn't fit switches to
+  // MODE_MEASURE instead and sets overflowed, which tells it apart from a DoState error.
+  // This lets callers write straight into a buffer of a previously seen size and only
+  // measure when it turns out to be too small.
+  bool bounded = false;
+  bool overflowed = false;
+  u8* end = nullptr;
+
 public:
   PointerWrap(u8** ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
+  PointerWrap(u8** ptr_, size_t size, Mode mode_)
+      : ptr(ptr_), mode(mode_), bounded(true), end(*ptr_ + size)
+  {
+  }
   void SetMode(Mode mode_) { mode = mode_; }
   Mode GetMode() const { return mode; }
+  bool Overflowed() const { return overflowed; }
   template <typename K, class V>
   void Do(std::map<K, V>& x)
   {
@@ -203,6 +216,9 @@ public:
     DoVoid((void*)&x, sizeof(x));
   }
 
+  // Moves past data that is neither read nor written, e.g. because it is known to be unchanged.
+  void Skip(u32 size) { *ptr += size; }
+
   void Do(bool& x)
   {
     // bool's size can vary depending on platform, which can
@@ -281,6 +297,12 @@ private:
       break;
 
     case MODE_WRITE:
+      if (bounded && size > static_cast<size_t>(end - *ptr))
+      {
+        overflowed = true;
+        mode = MODE_MEASURE;
+        break;
+      }
       memcpy(*ptr, data, size);
       break;
 
@@ -6,6 +6,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <xxhash.h>
+
 #include "Common/BitUtils.h"
 #include "Common/CPUDetect.h"
 #include "Common/CommonFuncs.h"
@@ -18,6 +20,7 @@
 namespace Common
 {
 static u64 (*ptrHashFunction)(const u8* src, u32 len, u32 samples) = nullptr;
+static u64 (*ptrSampledHashFunction)(const u8* src, u32 len, u32 samples) = nullptr;
 
 // uint32_t
 // WARNING - may read one more byte!
@@ -501,6 +504,17 @@ static u64 GetMurmurHash3(const u8* src, u32 len, u32 samples)
 }
 #endif
 
+// xxHash mixes four independent 64-bit lanes per 32 bytes, which outruns the CRC32 and Murmur
+// hashes on full-length inputs. Sampled hashes only read a handful of words spread over the
+// input, so those are left to the older functions.
+static u64 GetXXHash64(const u8* src, u32 len, u32 samples)
+{
+  if (samples == 0 || samples >= len / 8)
+    return XXH64(src, len, 0);
+
+  return ptrSampledHashFunction(src, len, samples);
+}
+
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
   return ptrHashFunction(src, len, samples);
@@ -512,18 +526,19 @@ void SetHash64Function()
 #if defined(_M_X86_64) || defined(_M_X86)
   if (cpu_info.bSSE4_2)  // sse crc32 version
   {
-    ptrHashFunction = &GetCRC32;
+    ptrSampledHashFunction = &GetCRC32;
   }
   else
 #elif defined(_M_ARM_64)
   if (cpu_info.bCRC32)
   {
-    ptrHashFunction = &GetCRC32;
+    ptrSampledHashFunction = &GetCRC32;
   }
   else
 #endif
   {
-    ptrHashFunction = &GetMurmurHash3;
+    ptrSampledHashFunction = &GetMurmurHash3;
   }
+  ptrHashFunction = &GetXXHash64;
 }
 }  // namespace Common
@@ -145,6 +145,8 @@ const ConfigInfo<bool> GFX_HACK_COPY_EFB_SCALED{{System::GFX, "Hacks", "EFBScale
 const ConfigInfo<bool> GFX_HACK_EFB_EMULATE_FORMAT_CHANGES{
     {System::GFX, "Hacks", "EFBEmulateFormatChanges"}, false};
 const ConfigInfo<bool> GFX_HACK_VERTEX_ROUDING{{System::GFX, "Hacks", "VertexRounding"}, false};
+const ConfigInfo<bool> GFX_HACK_TEXTURE_WRITE_TRACKING{
+    {System::GFX, "Hacks", "TextureWriteTracking"}, false};
 
 // Graphics.GameSpecific
 
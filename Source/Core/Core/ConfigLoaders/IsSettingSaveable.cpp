@@ -123,6 +123,7 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_HACK_COPY_EFB_SCALED.location,
       Config::GFX_HACK_EFB_EMULATE_FORMAT_CHANGES.location,
       Config::GFX_HACK_VERTEX_ROUDING.location,
+      Config::GFX_HACK_TEXTURE_WRITE_TRACKING.location,
 
       // Graphics.GameSpecific
 
@@ -206,6 +206,12 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("TimingVariance", iTimingVariance);
   core->Set("CPUCore", cpu_core);
   core->Set("Fastmem", bFastmem);
+  core->Set("PageTableFastmem", bPageTableFastmem);
+  core->Set("JITWarmStart", bJITWarmStart);
+  core->Set("JITNativeLoops", bJITNativeLoops);
+  core->Set("JITTiering", bJITTiering);
+  core->Set("JITInterpretFirst", bJITInterpretFirst);
+  core->Set("JITProfiling", bJITProfiling);
   core->Set("CPUThread", bCPUThread);
   core->Set("DSPHLE", bDSPHLE);
   core->Set("SyncOnSkipIdle", bSyncGPUOnSkipIdleHack);
@@ -461,6 +467,12 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 #endif
   core->Get("JITFollowBranch", &bJITFollowBranch, true);
   core->Get("Fastmem", &bFastmem, true);
+  core->Get("PageTableFastmem", &bPageTableFastmem, false);
+  core->Get("JITWarmStart", &bJITWarmStart, false);
+  core->Get("JITNativeLoops", &bJITNativeLoops, false);
+  core->Get("JITTiering", &bJITTiering, false);
+  core->Get("JITInterpretFirst", &bJITInterpretFirst, false);
+  core->Get("JITProfiling", &bJITProfiling, false);
   core->Get("DSPHLE", &bDSPHLE, true);
   core->Get("TimingVariance", &iTimingVariance, 40);
   core->Get("CPUThread", &bCPUThread, true);
@@ -703,6 +715,7 @@ void SConfig::LoadDefaults()
   bRunCompareServer = false;
   bDSPHLE = true;
   bFastmem = true;
+  bPageTableFastmem = false;
   bFPRF = false;
   bAccurateNaNs = false;
 #ifdef _M_X86_64
@@ -732,6 +745,11 @@ void SConfig::LoadDefaults()
   bJITPairedOff = false;
   bJITSystemRegistersOff = false;
   bJITBranchOff = false;
+  bJITWarmStart = false;
+  bJITNativeLoops = false;
+  bJITTiering = false;
+  bJITInterpretFirst = false;
+  bJITProfiling = false;
 
   ResetRunningGameMetadata();
 }
@@ -98,8 +98,14 @@ struct SConfig
   bool bJITPairedOff = false;
   bool bJITSystemRegistersOff = false;
   bool bJITBranchOff = false;
+  bool bJITWarmStart = false;
+  bool bJITNativeLoops = false;
+  bool bJITTiering = false;
+  bool bJITInterpretFirst = false;
+  bool bJITProfiling = false;
 
   bool bFastmem;
+  bool bPageTableFastmem = false;
   bool bFPRF = false;
   bool bAccurateNaNs = false;
 
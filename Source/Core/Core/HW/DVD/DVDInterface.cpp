@@ -31,6 +31,7 @@
 #include "Core/IOS/DI/DI.h"
 #include "Core/IOS/IOS.h"
 #include "Core/Movie.h"
+#include "Core/State.h"
 
 #include "DiscIO/Enums.h"
 #include "DiscIO/Volume.h"
@@ -448,6 +449,7 @@ void SetDisc(std::unique_ptr<DiscIO::Volume> disc)
 
   DVDThread::SetDisc(std::move(disc));
   SetLidOpen();
+  State::InvalidateLayout();
 }
 
 bool IsDiscInside()
@@ -12,6 +12,7 @@
 #include "Core/HW/EXI/EXI.h"
 #include "Core/HW/EXI/EXI_Device.h"
 #include "Core/HW/MMIO.h"
+#include "Core/State.h"
 
 namespace ExpansionInterface
 {
@@ -176,6 +177,7 @@ void CEXIChannel::AddDevice(std::unique_ptr<IEXIDevice> device, const int device
 
   // Replace it with the new one
   m_devices[device_num] = std::move(device);
+  State::InvalidateLayout();
 
   if (notify_presence_changed)
   {
@@ -10,13 +10,23 @@
 #include "Core/HW/Memmap.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Swap.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/AudioInterface.h"
@@ -120,6 +130,7 @@ struct LogicalMemoryView
 {
   void* mapped_pointer;
   u32 mapped_size;
+  u32 shm_position;
 };
 
 // Dolphin allocates memory to represent four regions:
@@ -170,6 +181,164 @@ static PhysicalMemoryRegion physical_regions[] = {
 };
 
 static std::vector<LogicalMemoryView> logical_mapped_entries;
+// Pages translated through the page table, keyed by logical address. See MapLogicalPage.
+static std::map<u32, LogicalMemoryView> page_mapped_entries;
+// The logical addresses of the above, keyed by their position in the arena. There can be
+// thousands of them, so protecting a page must not have to go through all of them.
+static std::multimap<u32, u32> page_mapped_positions;
+
+// Dirty page tracking, used to reload savestates quickly.
+//
+// While tracking is enabled, every page of the arena is write protected in all of its views
+// once a savestate has been saved or loaded. The first write to it afterwards faults, which
+// marks the page as dirty and lifts the protection again, so reloading that savestate only
+// needs to restore the pages that were actually written in between.
+//
+// When tracking isn't available, all pages simply stay dirty.
+//
+// Write watching reuses the same faults for the texture cache: watched pages are write
+// protected as well, and a write to one of them moves the page to a new write generation.
+//
+// Pages the OS is writing to on our behalf are pinned, and stay writable until it is done.
+static std::atomic<bool> s_dirty_tracking{false};
+static std::atomic<bool> s_write_watching{false};
+static bool s_reload_state = false;
+static u32 s_arena_size = 0;
+static std::vector<u8> s_dirty_pages;
+static std::vector<u8> s_watched_pages;
+static std::vector<u16> s_pinned_pages;
+static std::vector<u64> s_page_generations;
+static u64 s_write_generation = 1;
+// Guards the above as well as the logical views, as faults can come from any thread.
+//
+// HandleDirtyPageFault takes this lock from the fault handler. That is safe because the fault
+// is synchronous: it is raised by a write to emulated memory, never from within the lock or
+// unlock calls themselves, and no code holding the lock ever touches emulated memory (it only
+// changes protections and views), so a thread can't fault while it holds the lock. A fault
+// on another thread simply waits for the holder to finish.
+static std::mutex s_dirty_pages_lock;
+
+// Doesn't include the views of single pages from the page table, see ForEachPageView.
+template <typename Func>
+static void ForEachView(Func func)
+{
+  for (const PhysicalMemoryRegion& region : physical_regions)
+  {
+    if (*region.out_pointer)
+      func(*region.out_pointer, region.shm_position, region.size);
+  }
+#ifdef __LIBRETRO__
+  if (m_pContiguousRAM)
+    func(m_pContiguousRAM, 0, m_TotalMemorySize);
+#endif
+  for (const LogicalMemoryView& entry : logical_mapped_entries)
+    func(static_cast<u8*>(entry.mapped_pointer), entry.shm_position, entry.mapped_size);
+}
+
+// Calls func for the views of single pages within the given range of the arena, which must be
+// aligned to HW_PAGE_SIZE like the views themselves.
+template <typename Func>
+static void ForEachPageView(u32 position, u32 size, Func func)
+{
+  auto it = page_mapped_positions.lower_bound(position);
+  for (; it != page_mapped_positions.end() && it->first < position + size; ++it)
+  {
+    const LogicalMemoryView& entry = page_mapped_entries.at(it->second);
+    func(static_cast<u8*>(entry.mapped_pointer), entry.shm_position, entry.mapped_size);
+  }
+}
+
+static std::optional<u32> GetArenaPosition(uintptr_t address)
+{
+  // Views of single pages sit at their logical address, so they can be looked up directly.
+  const uintptr_t logical = reinterpret_cast<uintptr_t>(logical_base);
+  if (logical_base && address >= logical && address - logical <= UINT32_MAX)
+  {
+    const u32 logical_address = static_cast<u32>(address - logical);
+    const auto it = page_mapped_entries.find(logical_address & ~(HW_PAGE_SIZE - 1));
+    if (it != page_mapped_entries.end())
+      return it->second.shm_position + (logical_address & (HW_PAGE_SIZE - 1));
+  }
+
+  std::optional<u32> position;
+  ForEachView([&](u8* view, u32 shm_position, u32 size) {
+    const uintptr_t base = reinterpret_cast<uintptr_t>(view);
+    if (address >= base && address - base < size)
+      position = shm_position + static_cast<u32>(address - base);
+  });
+  return position;
+}
+
+static void SetPageProtection(u32 page, bool write_protect)
+{
+  const u32 position = page * DIRTY_PAGE_SIZE;
+  const auto protect = [&](u8* view, u32 shm_position, u32 size) {
+    // Views of single pages from the page table can be smaller than a dirty page.
+    const u32 start = std::max(position, shm_position);
+    const u32 end = std::min(position + DIRTY_PAGE_SIZE, shm_position + size);
+    if (start >= end)
+      return;
+
+    u8* pointer = view + (start - shm_position);
+    if (write_protect)
+      Common::WriteProtectMemory(pointer, end - start);
+    else
+      Common::UnWriteProtectMemory(pointer, end - start);
+  };
+  ForEachView(protect);
+  ForEachPageView(position, DIRTY_PAGE_SIZE, protect);
+}
+
+static bool IsPageProtected(u32 page)
+{
+  return !s_pinned_pages[page] && (!s_dirty_pages[page] || s_watched_pages[page]);
+}
+
+static void MarkPageWritten(u32 page)
+{
+  const bool was_protected = IsPageProtected(page);
+  s_dirty_pages[page] = 1;
+  s_watched_pages[page] = 0;
+  s_page_generations[page] = ++s_write_generation;
+  if (was_protected)
+    SetPageProtection(page, false);
+}
+
+static void MarkPagesDirty(u32 position, size_t size)
+{
+  const u32 first_page = position / DIRTY_PAGE_SIZE;
+  const u32 last_page = static_cast<u32>((position + size - 1) / DIRTY_PAGE_SIZE);
+  for (u32 page = first_page; page <= last_page && page < s_dirty_pages.size(); ++page)
+    MarkPageWritten(page);
+}
+
+static void MarkAllPagesDirty()
+{
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  if (s_arena_size)
+    MarkPagesDirty(0, s_arena_size);
+}
+
+static void ProtectCleanPages()
+{
+  for (u32 page = 0; page < s_dirty_pages.size(); ++page)
+  {
+    if (IsPageProtected(page))
+      SetPageProtection(page, true);
+  }
+}
+
+static bool CanTrackWrites()
+{
+  // Writes from other threads than the CPU thread must also be caught, which requires the
+  // process-wide fault handler that gets installed alongside fastmem. On macOS, the exception
+  // port is only set up for the CPU thread.
+#if defined(__APPLE__) || defined(_M_GENERIC) || defined(_ARCH_32)
+  return false;
+#else
+  return SConfig::GetInstance().bFastmem;
+#endif
+}
 
 void Init()
 {
@@ -197,6 +366,11 @@ void Init()
     mem_size += region.size;
   }
   g_arena.GrabSHMSegment(mem_size);
+  s_arena_size = mem_size;
+  s_dirty_pages.assign(mem_size / DIRTY_PAGE_SIZE, 1);
+  s_watched_pages.assign(mem_size / DIRTY_PAGE_SIZE, 0);
+  s_pinned_pages.assign(mem_size / DIRTY_PAGE_SIZE, 0);
+  s_page_generations.assign(mem_size / DIRTY_PAGE_SIZE, s_write_generation);
   physical_base = Common::MemArena::FindMemoryBase();
 
   for (PhysicalMemoryRegion& region : physical_regions)
@@ -241,13 +415,37 @@ void Init()
   m_IsInitialized = true;
 }
 
+static void ReleasePageViews()
+{
+  for (auto& entry : page_mapped_entries)
+    g_arena.ReleaseView(entry.second.mapped_pointer, entry.second.mapped_size);
+  page_mapped_entries.clear();
+  page_mapped_positions.clear();
+}
+
+static void ErasePagePosition(const LogicalMemoryView& view, u32 logical_address)
+{
+  const auto range = page_mapped_positions.equal_range(view.shm_position);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second == logical_address)
+    {
+      page_mapped_positions.erase(it);
+      return;
+    }
+  }
+}
+
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 {
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
   for (auto& entry : logical_mapped_entries)
   {
     g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
   }
   logical_mapped_entries.clear();
+  // BATs take priority over the page table, so the pages have to be mapped again on demand.
+  ReleasePageViews();
   for (u32 i = 0; i < dbat_table.size(); ++i)
   {
     if (dbat_table[i] & PowerPC::BAT_PHYSICAL_BIT)
@@ -275,30 +473,298 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
             PanicAlert("MemoryMap_Setup: Failed finding a memory base.");
             exit(0);
           }
-          logical_mapped_entries.push_back({mapped_pointer, mapped_size});
+          logical_mapped_entries.push_back({mapped_pointer, mapped_size, position});
         }
       }
     }
   }
+
+  // The new views start out writable.
+  if (s_dirty_tracking || s_write_watching)
+    ProtectCleanPages();
+}
+
+bool MapLogicalPage(u32 logical_address, u32 translated_address)
+{
+  // Views have to be aligned to the host's allocation granularity, which is 64KiB on Windows.
+#ifdef _WIN32
+  return false;
+#else
+  static const bool host_pages_fit = sysconf(_SC_PAGESIZE) == HW_PAGE_SIZE;
+  if (!host_pages_fit || !logical_base)
+    return false;
+
+  for (const PhysicalMemoryRegion& physical_region : physical_regions)
+  {
+    if (!*physical_region.out_pointer ||
+        translated_address - physical_region.physical_address >= physical_region.size)
+    {
+      continue;
+    }
+
+    const u32 position =
+        physical_region.shm_position + translated_address - physical_region.physical_address;
+
+    std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+    void* mapped_pointer =
+        g_arena.CreateView(position, HW_PAGE_SIZE, logical_base + logical_address);
+    if (!mapped_pointer)
+      return false;
+
+    // The view replaces any earlier one at the same address.
+    const auto existing = page_mapped_entries.find(logical_address);
+    if (existing != page_mapped_entries.end())
+      ErasePagePosition(existing->second, logical_address);
+    page_mapped_entries[logical_address] = {mapped_pointer, HW_PAGE_SIZE, position};
+    page_mapped_positions.emplace(position, logical_address);
+
+    // The new view starts out writable.
+    if (IsPageProtected(position / DIRTY_PAGE_SIZE))
+      Common::WriteProtectMemory(mapped_pointer, HW_PAGE_SIZE);
+    return true;
+  }
+  return false;
+#endif
+}
+
+void UnmapLogicalPage(u32 logical_address)
+{
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  const auto it = page_mapped_entries.find(logical_address);
+  if (it == page_mapped_entries.end())
+    return;
+
+  g_arena.ReleaseView(it->second.mapped_pointer, it->second.mapped_size);
+  ErasePagePosition(it->second, logical_address);
+  page_mapped_entries.erase(it);
+}
+
+void EnableDirtyPageTracking(bool enable)
+{
+  enable = enable && CanTrackWrites();
+
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  if (enable == s_dirty_tracking)
+    return;
+
+  // Either way, start over with everything dirty and writable.
+  if (s_arena_size)
+    MarkPagesDirty(0, s_arena_size);
+  s_dirty_tracking = enable;
+}
+
+void EnableWriteWatching(bool enable)
+{
+  enable = enable && CanTrackWrites();
+
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  if (enable == s_write_watching)
+    return;
+
+  // Watches are lost either way, so everything moves to a new generation.
+  if (s_arena_size)
+    MarkPagesDirty(0, s_arena_size);
+  s_write_watching = enable;
+}
+
+u64 WatchWrites(const u8* pointer, size_t size)
+{
+  if (!s_write_watching || size == 0)
+    return 0;
+
+  // Callers hand in pointers from GetPointer, so only the physical views need to be searched.
+  std::optional<u32> position;
+  for (const PhysicalMemoryRegion& region : physical_regions)
+  {
+    const u8* view = *region.out_pointer;
+    if (view && pointer >= view && pointer + size <= view + region.size)
+      position = region.shm_position + static_cast<u32>(pointer - view);
+  }
+  if (!position)
+    return 0;
+
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  if (!s_write_watching)
+    return 0;
+
+  // Each write moves its page to a higher generation than any before, so the highest generation
+  // in the range changes whenever any of its pages is written.
+  u64 generation = 0;
+  const u32 first_page = *position / DIRTY_PAGE_SIZE;
+  const u32 last_page = static_cast<u32>((*position + size - 1) / DIRTY_PAGE_SIZE);
+  for (u32 page = first_page; page <= last_page; ++page)
+  {
+    // Pinned pages are only protected once they are unpinned, which also ends the watch.
+    const bool was_protected = IsPageProtected(page);
+    s_watched_pages[page] = 1;
+    if (!was_protected && IsPageProtected(page))
+      SetPageProtection(page, true);
+    generation = std::max(generation, s_page_generations[page]);
+  }
+  return generation;
+}
+
+bool HandleDirtyPageFault(uintptr_t access_address)
+{
+  if (!s_dirty_tracking && !s_write_watching)
+    return false;
+
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  const std::optional<u32> position = GetArenaPosition(access_address);
+  if ((!s_dirty_tracking && !s_write_watching) || !position)
+    return false;
+
+  // Another thread may have raced us here; lifting the protection again is harmless.
+  const u32 page = *position / DIRTY_PAGE_SIZE;
+  s_dirty_pages[page] = 1;
+  s_watched_pages[page] = 0;
+  s_page_generations[page] = ++s_write_generation;
+  SetPageProtection(page, false);
+  return true;
+}
+
+HostWriteScope::HostWriteScope(const u8* pointer, size_t size)
+{
+  if (size == 0)
+    return;
+
+  // Pin regardless of whether tracking is enabled, it may be enabled before the write is done.
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  const std::optional<u32> position = GetArenaPosition(reinterpret_cast<uintptr_t>(pointer));
+  if (!position || s_pinned_pages.empty())
+    return;
+
+  m_first_page = *position / DIRTY_PAGE_SIZE;
+  const u64 last_page = std::min<u64>((*position + size - 1) / DIRTY_PAGE_SIZE,
+                                      s_pinned_pages.size() - 1);
+  m_page_count = static_cast<u32>(last_page - m_first_page + 1);
+  for (u32 page = m_first_page; page <= last_page; ++page)
+  {
+    MarkPageWritten(page);
+    ++s_pinned_pages[page];
+  }
+}
+
+HostWriteScope::~HostWriteScope()
+{
+  if (m_page_count == 0)
+    return;
+
+  // Anything that watched the pages in the meantime has to see the write.
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  for (u32 page = m_first_page; page < m_first_page + m_page_count && page < s_pinned_pages.size();
+       ++page)
+  {
+    --s_pinned_pages[page];
+    MarkPageWritten(page);
+  }
+}
+
+// Protects all pages again, once memory matches a savestate.
+static void LatchDirtyPages()
+{
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  for (u32 page = 0; page < s_dirty_pages.size(); ++page)
+  {
+    if (!s_dirty_pages[page])
+      continue;
+
+    // Pinned pages are written as we speak, so they stay dirty.
+    if (s_pinned_pages[page])
+      continue;
+
+    s_dirty_pages[page] = 0;
+    if (!s_watched_pages[page])
+      SetPageProtection(page, true);
+  }
+}
+
+// Lifts the protection of every page written since the last latch, as they are about to be
+// restored, and returns them.
+static std::vector<u8> TakeDirtyPages()
+{
+  std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+  for (u32 page = 0; page < s_dirty_pages.size(); ++page)
+  {
+    if (s_dirty_pages[page])
+      MarkPageWritten(page);
+  }
+  return s_dirty_pages;
+}
+
+void SetReloadState(bool reload)
+{
+  s_reload_state = reload;
+}
+
+static void DoRegion(PointerWrap& p, u8* pointer, u32 size, const std::vector<u8>* pages)
+{
+  if (!pointer)
+    return;
+
+  const auto region =
+      std::find_if(std::begin(physical_regions), std::end(physical_regions),
+                   [&](const PhysicalMemoryRegion& r) { return *r.out_pointer == pointer; });
+  if (!pages || region == std::end(physical_regions))
+  {
+    p.DoArray(pointer, size);
+    return;
+  }
+
+  for (u32 offset = 0; offset < size; offset += DIRTY_PAGE_SIZE)
+  {
+    const u32 page = (region->shm_position + offset) / DIRTY_PAGE_SIZE;
+    if ((*pages)[page])
+      p.DoArray(pointer + offset, DIRTY_PAGE_SIZE);
+    else
+      p.Skip(DIRTY_PAGE_SIZE);
+  }
 }
 
 void DoState(PointerWrap& p)
 {
+  // Loading rewrites everything; don't take a fault for each page while doing so. When reloading
+  // the state memory was last latched to, only the pages written since need to be restored.
+  std::vector<u8> dirty_pages;
+  const bool reload = s_reload_state && s_dirty_tracking && p.GetMode() == PointerWrap::MODE_READ;
+  if (reload)
+    dirty_pages = TakeDirtyPages();
+  else if (p.GetMode() == PointerWrap::MODE_READ)
+    MarkAllPagesDirty();
+  const std::vector<u8>* pages = reload ? &dirty_pages : nullptr;
+
   bool wii = SConfig::GetInstance().bWii;
-  p.DoArray(m_pRAM, RAM_SIZE);
-  p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
+  DoRegion(p, m_pRAM, RAM_SIZE, pages);
+  DoRegion(p, m_pL1Cache, L1_CACHE_SIZE, pages);
   p.DoMarker("Memory RAM");
-  if (m_pFakeVMEM)
-    p.DoArray(m_pFakeVMEM, FAKEVMEM_SIZE);
+  DoRegion(p, m_pFakeVMEM, FAKEVMEM_SIZE, pages);
   p.DoMarker("Memory FakeVMEM");
   if (wii)
-    p.DoArray(m_pEXRAM, EXRAM_SIZE);
+    DoRegion(p, m_pEXRAM, EXRAM_SIZE, pages);
   p.DoMarker("Memory EXRAM");
+
+  // Memory now matches the savestate, so start tracking the writes made from here on.
+  if (s_dirty_tracking &&
+      (p.GetMode() == PointerWrap::MODE_READ || p.GetMode() == PointerWrap::MODE_WRITE))
+  {
+    LatchDirtyPages();
+  }
 }
 
 void Shutdown()
 {
   m_IsInitialized = false;
+  {
+    std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+    s_dirty_tracking = false;
+    s_write_watching = false;
+    s_reload_state = false;
+    s_arena_size = 0;
+    s_dirty_pages.clear();
+    s_watched_pages.clear();
+    s_pinned_pages.clear();
+    s_page_generations.clear();
+  }
   u32 flags = 0;
   if (SConfig::GetInstance().bWii)
     flags |= PhysicalMemoryRegion::WII_ONLY;
@@ -315,11 +781,15 @@ void Shutdown()
   g_arena.ReleaseView(m_pContiguousRAM, m_TotalMemorySize);
   m_pContiguousRAM = nullptr;
 #endif
-  for (auto& entry : logical_mapped_entries)
   {
-    g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
+    std::lock_guard<std::mutex> lk(s_dirty_pages_lock);
+    for (auto& entry : logical_mapped_entries)
+    {
+      g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
+    }
+    logical_mapped_entries.clear();
+    ReleasePageViews();
   }
-  logical_mapped_entries.clear();
   g_arena.ReleaseSHMSegment();
   physical_base = nullptr;
   logical_base = nullptr;
@@ -57,6 +57,11 @@ enum
   IO_SIZE = 0x00010000,
   EXRAM_SIZE = 0x04000000,
   EXRAM_MASK = EXRAM_SIZE - 1,
+  // Granularity of dirty page tracking. Larger than the host page size on all supported
+  // hosts, so that it works for 4KiB as well as 16KiB pages.
+  DIRTY_PAGE_SIZE = 0x00004000,
+  // Granularity of page table translations.
+  HW_PAGE_SIZE = 0x00001000,
 };
 
 // MMIO mapping object.
@@ -69,6 +74,42 @@ void Shutdown();
 void DoState(PointerWrap& p);
 
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table);
+// Maps a single page translated through the page table into the logical view, so that fastmem
+// accesses to it succeed. Fails on hosts whose pages are larger than the emulated ones. The page
+// is unmapped again by UnmapLogicalPage or the next UpdateLogicalMemory.
+bool MapLogicalPage(u32 logical_address, u32 translated_address);
+void UnmapLogicalPage(u32 logical_address);
+
+// Dirty page tracking for reloading savestates. Pages of emulated memory are write protected
+// once a savestate has been saved or loaded, so that reloading it only has to restore the pages
+// written since. Tracking relies on the fastmem fault handler and silently stays off where that
+// isn't available, in which case savestates are always loaded in full.
+void EnableDirtyPageTracking(bool enable);
+bool HandleDirtyPageFault(uintptr_t access_address);
+// Writes done by the OS on our behalf (file reads, socket receives) fail instead of faulting
+// on write protected memory, so emulated memory must be held writable while they happen. For as
+// long as the scope lives, the pages backing the range are neither protected nor watched. They
+// count as written once it ends.
+class HostWriteScope
+{
+public:
+  HostWriteScope(const u8* pointer, size_t size);
+  ~HostWriteScope();
+  HostWriteScope(const HostWriteScope&) = delete;
+  HostWriteScope& operator=(const HostWriteScope&) = delete;
+
+private:
+  u32 m_first_page = 0;
+  u32 m_page_count = 0;
+};
+// While set, loading a savestate only restores the pages written since the last savestate was
+// saved or loaded. Only valid when loading that very savestate again.
+void SetReloadState(bool reload);
+// Write watching on top of the same mechanism. WatchWrites write protects the pages backing the
+// given host pointer range and returns a generation that changes whenever any of them is
+// written afterwards, or 0 if the range can't be watched.
+void EnableWriteWatching(bool enable);
+u64 WatchWrites(const u8* pointer, size_t size);
 
 void Clear();
 
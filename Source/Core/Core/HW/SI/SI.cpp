@@ -20,6 +20,7 @@
 #include "Core/HW/SystemTimers.h"
 #include "Core/Movie.h"
 #include "Core/NetPlayProto.h"
+#include "Core/State.h"
 
 #include "InputCommon/ControllerInterface/ControllerInterface.h"
 
@@ -585,6 +586,7 @@ void AddDevice(std::unique_ptr<ISIDevice> device)
 
   // Set the new one
   s_channel.at(device_number).device = std::move(device);
+  State::InvalidateLayout();
 }
 
 void AddDevice(const SIDevices device, int device_number)
@@ -19,6 +19,7 @@
 #include "Common/FileUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/IOS/Device.h"
 #include "Core/IOS/IOS.h"
 
@@ -553,6 +554,7 @@ void WiiSocket::Update(bool read, bool write, bool except)
           }
 #endif
           socklen_t addrlen = sizeof(sockaddr_in);
+          Memory::HostWriteScope host_write(reinterpret_cast<u8*>(data), data_len);
           int ret = recvfrom(fd, data, data_len, flags,
                              BufferOutSize2 ? (struct sockaddr*)&local_name : nullptr,
                              BufferOutSize2 ? &addrlen : nullptr);
@@ -251,6 +251,7 @@ s32 SDIOSlot0::ExecuteCommand(const Request& request, u32 _BufferIn, u32 _Buffer
       if (!m_card.Seek(address, SEEK_SET))
         ERROR_LOG(IOS_SD, "Seek failed WTF");
 
+      Memory::HostWriteScope host_write(Memory::GetPointer(req.addr), size);
       if (m_card.ReadBytes(Memory::GetPointer(req.addr), size))
       {
         DEBUG_LOG(IOS_SD, "Outbuffer size %i got %i", _rwBufferSize, size);
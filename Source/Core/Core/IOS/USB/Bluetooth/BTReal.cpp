@@ -280,11 +280,13 @@ void BluetoothReal::DoState(PointerWrap& p)
     return;
   }
 
-  // Prevent the transfer callbacks from messing with m_current_transfers after we have started
-  // writing a savestate. We cannot use a scoped lock here because DoState is called twice and
-  // we would lose the lock between the two calls.
-  if (p.GetMode() == PointerWrap::MODE_MEASURE || p.GetMode() == PointerWrap::MODE_VERIFY)
-    m_transfers_mutex.lock();
+  // Prevent the transfer callbacks from messing with m_current_transfers while it is saved.
+  // States are not necessarily measured before they are written, so the lock can't be held from
+  // one DoState call to the next. Writes are bounded by the measured size, so a transfer that
+  // completes in between only makes the write come up short and be redone.
+  std::unique_lock<std::mutex> lk(m_transfers_mutex, std::defer_lock);
+  if (p.GetMode() != PointerWrap::MODE_READ)
+    lk.lock();
 
   std::vector<u32> addresses_to_discard;
   if (p.GetMode() != PointerWrap::MODE_READ)
@@ -322,10 +324,6 @@ void BluetoothReal::DoState(PointerWrap& p)
 #endif
     s_has_shown_savestate_warning = true;
   }
-
-  // We have finished the savestate now, so the transfers mutex can be unlocked.
-  if (p.GetMode() == PointerWrap::MODE_WRITE)
-    m_transfers_mutex.unlock();
 }
 
 void BluetoothReal::UpdateSyncButtonState(const bool is_held)
@@ -14,6 +14,9 @@
 
 namespace IOS::HLE::USB
 {
+// Transfers go through a host buffer rather than emulated memory, so the OS never writes to
+// emulated memory behind the back of dirty page tracking (see Memory::HostWriteScope):
+// the data only reaches it through the copy in FillBuffer.
 std::unique_ptr<u8[]> TransferCommand::MakeBuffer(const size_t size) const
 {
   ASSERT_MSG(IOS_USB, data_address != 0, "Invalid data_address");
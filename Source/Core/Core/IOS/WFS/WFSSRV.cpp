@@ -296,6 +296,7 @@ IPCCommandResult WFSSRV::IOCtl(const IOCtlRequest& request)
       fd_obj->file.Seek(position, SEEK_SET);
     }
     size_t read_bytes;
+    Memory::HostWriteScope host_write(Memory::GetPointer(addr), size);
     fd_obj->file.ReadArray(Memory::GetPointer(addr), size, &read_bytes);
     // TODO(wfs): Handle read errors.
     if (absolute)
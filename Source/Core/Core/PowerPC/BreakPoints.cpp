@@ -175,6 +175,8 @@ void MemChecks::Add(const TMemCheck& memory_check)
     // watchpoint-compatible code.
     if (!had_any)
       JitInterface::ClearCache();
+    // This also unmaps every page fastmem mapped from the page table, so accesses to the new
+    // range fault again and are turned away by HandleFastmemPageFault.
     PowerPC::DBATUpdated();
   });
 }
@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
 
+#include "Common/BitUtils.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Core/ConfigManager.h"
@@ -11,6 +12,7 @@
 #include "Core/HLE/HLE.h"
 #include "Core/HW/CPU.h"
 #include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64Common/Jit64Constants.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -19,6 +21,20 @@ struct CachedInterpreter::Instruction
 {
   using CommonCallback = void (*)(UGeckoInstruction);
   using ConditionalCallback = bool (*)(u32);
+  using FusedCallback = void (*)(UGeckoInstruction, UGeckoInstruction);
+
+  enum class Type
+  {
+    Abort,
+    Common,
+    Conditional,
+    // A superinstruction, which runs two guest instructions with a single dispatch.
+    Fused,
+    // Executed inline by ExecuteOneBlock, without calling anything.
+    WritePC,
+    EndBlock,
+    RotateMask,
+  };
 
   Instruction() {}
   Instruction(const CommonCallback c, UGeckoInstruction i)
@@ -31,20 +47,22 @@ struct CachedInterpreter::Instruction
   {
   }
 
-  enum class Type
+  Instruction(const FusedCallback c, UGeckoInstruction first, UGeckoInstruction second)
+      : fused_callback(c), data(first.hex), data2(second.hex), type(Type::Fused)
   {
-    Abort,
-    Common,
-    Conditional,
-  };
+  }
+
+  Instruction(Type t, u32 d, u32 d2 = 0) : data(d), data2(d2), type(t) {}
 
   union
   {
     const CommonCallback common_callback;
     const ConditionalCallback conditional_callback;
+    const FusedCallback fused_callback;
   };
 
   u32 data = 0;
+  u32 data2 = 0;
   Type type = Type::Abort;
 };
 
@@ -100,6 +118,28 @@ void CachedInterpreter::ExecuteOneBlock()
         return;
       break;
 
+    case Instruction::Type::Fused:
+      code->fused_callback(UGeckoInstruction(code->data), UGeckoInstruction(code->data2));
+      break;
+
+    case Instruction::Type::WritePC:
+      PC = code->data;
+      NPC = code->data + 4;
+      break;
+
+    case Instruction::Type::EndBlock:
+      PC = NPC;
+      PowerPC::ppcState.downcount -= code->data;
+      break;
+
+    case Instruction::Type::RotateMask:
+    {
+      // rlwinm without Rc, with the mask in data2
+      const UGeckoInstruction inst(code->data);
+      rGPR[inst.RA] = Common::RotateLeft(rGPR[inst.RS], inst.SH) & code->data2;
+      break;
+    }
+
     default:
       ERROR_LOG(POWERPC, "Unknown CachedInterpreter Instruction: %d", static_cast<int>(code->type));
       break;
@@ -130,21 +170,16 @@ void CachedInterpreter::SingleStep()
   ExecuteOneBlock();
 }
 
-static void EndBlock(UGeckoInstruction data)
-{
-  PC = NPC;
-  PowerPC::ppcState.downcount -= data.hex;
-}
-
-static void WritePC(UGeckoInstruction data)
+static void WriteBrokenBlockNPC(UGeckoInstruction data)
 {
-  PC = data.hex;
-  NPC = data.hex + 4;
+  NPC = data.hex;
 }
 
-static void WriteBrokenBlockNPC(UGeckoInstruction data)
+static void CheckIdle(UGeckoInstruction data)
 {
-  NPC = data.hex;
+  // The loop branched back to its start, so nothing will change until the next event.
+  if (NPC == data.hex)
+    CoreTiming::Idle();
 }
 
 static bool CheckFPU(u32 data)
@@ -181,16 +216,122 @@ static bool CheckBreakpoint(u32 data)
   return false;
 }
 
+static bool IsCompare(UGeckoInstruction inst)
+{
+  return inst.OPCD == 10 || inst.OPCD == 11 ||
+         (inst.OPCD == 31 && (inst.SUBOP10 == 0 || inst.SUBOP10 == 32));
+}
+
+// cmp/cmpl/cmpi/cmpli followed by bc
+static void CompareAndBranch(UGeckoInstruction cmp, UGeckoInstruction bc)
+{
+  const u32 a = rGPR[cmp.RA];
+  bool is_signed;
+  u32 b;
+  switch (cmp.OPCD)
+  {
+  case 10:
+    is_signed = false;
+    b = cmp.UIMM;
+    break;
+  case 11:
+    is_signed = true;
+    b = static_cast<u32>(cmp.SIMM_16);
+    break;
+  default:
+    is_signed = cmp.SUBOP10 == 0;
+    b = rGPR[cmp.RB];
+    break;
+  }
+
+  u32 f;
+  if (is_signed ? static_cast<s32>(a) < static_cast<s32>(b) : a < b)
+    f = 0x8;
+  else if (is_signed ? static_cast<s32>(a) > static_cast<s32>(b) : a > b)
+    f = 0x4;
+  else
+    f = 0x2;
+
+  if (PowerPC::GetXER_SO())
+    f |= 0x1;
+
+  PowerPC::SetCRField(cmp.CRFD, f);
+  Interpreter::bcx(bc);
+}
+
+// lwz followed by addi, usually advancing the pointer it loaded from
+static void LoadWordAndAddImmediate(UGeckoInstruction lwz, UGeckoInstruction addi)
+{
+  Interpreter::lwz(lwz);
+  Interpreter::addi(addi);
+}
+
+// stw followed by addi, usually advancing the pointer it stored to
+static void StoreWordAndAddImmediate(UGeckoInstruction stw, UGeckoInstruction addi)
+{
+  Interpreter::stw(stw);
+  Interpreter::addi(addi);
+}
+
+// Two rlwinm without Rc, e.g. extracting a bitfield and scaling it to an offset
+static void RotateMaskTwice(UGeckoInstruction first, UGeckoInstruction second)
+{
+  rGPR[first.RA] =
+      Common::RotateLeft(rGPR[first.RS], first.SH) & MakeRotationMask(first.MB, first.ME);
+  rGPR[second.RA] =
+      Common::RotateLeft(rGPR[second.RS], second.SH) & MakeRotationMask(second.MB, second.ME);
+}
+
+bool CachedInterpreter::EmitSuperinstruction(const PPCAnalyst::CodeOp& op,
+                                             const PPCAnalyst::CodeOp& next)
+{
+  // Both instructions must be free of anything that has to run between them.
+  if (next.skip || SConfig::GetInstance().bEnableDebugging ||
+      HLE::GetFirstFunctionIndex(next.address))
+  {
+    return false;
+  }
+
+  const UGeckoInstruction inst = op.inst;
+  const UGeckoInstruction next_inst = next.inst;
+
+  if (IsCompare(inst) && next_inst.OPCD == 16)
+  {
+    js.downcountAmount += next.opinfo->numCycles;
+    m_code.emplace_back(Instruction::Type::WritePC, next.address);
+    m_code.emplace_back(CompareAndBranch, inst, next_inst);
+    if (next.branchIsIdleLoop)
+      m_code.emplace_back(CheckIdle, js.blockStart);
+    m_code.emplace_back(Instruction::Type::EndBlock, js.downcountAmount);
+    return true;
+  }
+
+  Instruction::FusedCallback fused = nullptr;
+  if (inst.OPCD == 32 && next_inst.OPCD == 14 && !jo.memcheck)
+    fused = LoadWordAndAddImmediate;
+  else if (inst.OPCD == 36 && next_inst.OPCD == 14 && !jo.memcheck)
+    fused = StoreWordAndAddImmediate;
+  else if (inst.OPCD == 21 && !inst.Rc && next_inst.OPCD == 21 && !next_inst.Rc)
+    fused = RotateMaskTwice;
+
+  if (!fused)
+    return false;
+
+  js.downcountAmount += next.opinfo->numCycles;
+  m_code.emplace_back(fused, inst, next_inst);
+  return true;
+}
+
 bool CachedInterpreter::HandleFunctionHooking(u32 address)
 {
   return HLE::ReplaceFunctionIfPossible(address, [&](u32 function, HLE::HookType type) {
-    m_code.emplace_back(WritePC, address);
+    m_code.emplace_back(Instruction::Type::WritePC, address);
     m_code.emplace_back(Interpreter::HLEFunction, function);
 
     if (type != HLE::HookType::Replace)
       return false;
 
-    m_code.emplace_back(EndBlock, js.downcountAmount);
+    m_code.emplace_back(Instruction::Type::EndBlock, js.downcountAmount);
     m_code.emplace_back();
     return true;
   });
@@ -245,30 +386,46 @@ void CachedInterpreter::Jit(u32 address)
 
       if (breakpoint)
       {
-        m_code.emplace_back(WritePC, op.address);
+        m_code.emplace_back(Instruction::Type::WritePC, op.address);
         m_code.emplace_back(CheckBreakpoint, js.downcountAmount);
       }
 
       if (check_fpu)
       {
-        m_code.emplace_back(WritePC, op.address);
+        m_code.emplace_back(Instruction::Type::WritePC, op.address);
         m_code.emplace_back(CheckFPU, js.downcountAmount);
         js.firstFPInstructionFound = true;
       }
 
+      if (i + 1 < code_block.m_num_instructions &&
+          EmitSuperinstruction(op, m_code_buffer[i + 1]))
+      {
+        // The next instruction is part of the superinstruction.
+        if (m_code_buffer[i + 1].opinfo->flags & FL_ENDBLOCK)
+          break;
+        i++;
+        continue;
+      }
+
       if (endblock || memcheck)
-        m_code.emplace_back(WritePC, op.address);
-      m_code.emplace_back(PPCTables::GetInterpreterOp(op.inst), op.inst);
+        m_code.emplace_back(Instruction::Type::WritePC, op.address);
+      if (op.inst.OPCD == 21 && !op.inst.Rc)
+        m_code.emplace_back(Instruction::Type::RotateMask, op.inst.hex,
+                            MakeRotationMask(op.inst.MB, op.inst.ME));
+      else
+        m_code.emplace_back(PPCTables::GetInterpreterOp(op.inst), op.inst);
       if (memcheck)
         m_code.emplace_back(CheckDSI, js.downcountAmount);
+      if (op.branchIsIdleLoop)
+        m_code.emplace_back(CheckIdle, js.blockStart);
       if (endblock)
-        m_code.emplace_back(EndBlock, js.downcountAmount);
+        m_code.emplace_back(Instruction::Type::EndBlock, js.downcountAmount);
     }
   }
   if (code_block.m_broken)
   {
     m_code.emplace_back(WriteBrokenBlockNPC, nextPC);
-    m_code.emplace_back(EndBlock, js.downcountAmount);
+    m_code.emplace_back(Instruction::Type::EndBlock, js.downcountAmount);
   }
   m_code.emplace_back();
 
@@ -38,6 +38,7 @@ private:
   u8* GetCodePtr();
   void ExecuteOneBlock();
 
+  bool EmitSuperinstruction(const PPCAnalyst::CodeOp& op, const PPCAnalyst::CodeOp& next);
   bool HandleFunctionHooking(u32 address);
 
   BlockCache m_block_cache{*this};
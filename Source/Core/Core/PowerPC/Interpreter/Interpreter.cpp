@@ -238,6 +238,18 @@ void Interpreter::SingleStep()
   }
 }
 
+int Interpreter::SingleStepBlock()
+{
+  m_end_block = false;
+
+  int cycles = 0;
+  while (!m_end_block)
+  {
+    cycles += SingleStepInner();
+  }
+  return cycles;
+}
+
 //#define SHOW_HISTORY
 #ifdef SHOW_HISTORY
 std::vector<int> PCVec;
@@ -319,14 +331,7 @@ void Interpreter::Run()
       // "fast" version of inner loop. well, it's not so fast.
       while (PowerPC::ppcState.downcount > 0)
       {
-        m_end_block = false;
-
-        int cycles = 0;
-        while (!m_end_block)
-        {
-          cycles += SingleStepInner();
-        }
-        PowerPC::ppcState.downcount -= cycles;
+        PowerPC::ppcState.downcount -= SingleStepBlock();
       }
     }
   }
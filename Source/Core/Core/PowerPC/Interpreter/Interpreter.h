@@ -17,6 +17,9 @@ public:
   void Shutdown() override;
   void SingleStep() override;
   int SingleStepInner();
+  // Executes instructions up to and including the next one which ends a block (a branch, rfi,
+  // an exception...) and returns the number of cycles they took.
+  int SingleStepBlock();
 
   void Run() override;
   void ClearCache() override;
@@ -32,6 +32,7 @@
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/MachineContext.h"
 #include "Core/PatchEngine.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/RegCache/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/FarCodeCache.h"
@@ -231,7 +232,13 @@ bool Jit64::HandleFault(uintptr_t access_address, SContext* ctx)
 
   const auto logical_base_ptr = reinterpret_cast<uintptr_t>(Memory::logical_base);
   if (access_address >= logical_base_ptr && access_address < logical_base_ptr + 0x100010000)
-    return BackPatch(static_cast<u32>(access_address - logical_base_ptr), ctx);
+  {
+    const u32 em_address = static_cast<u32>(access_address - logical_base_ptr);
+    // Pages from the page table get mapped on their first access, after which it can be retried.
+    if (IsInSpace(reinterpret_cast<u8*>(ctx->CTX_PC)) && PowerPC::HandleFastmemPageFault(em_address))
+      return true;
+    return BackPatch(em_address, ctx);
+  }
 
   return false;
 }
@@ -658,6 +665,27 @@ void Jit64::WriteExceptionExit()
   JMP(asm_routines.dispatcher, true);
 }
 
+// Used by branches which close an idle loop: nothing changes until the next event, so skip to it.
+void Jit64::WriteIdleExit(u32 destination)
+{
+  ABI_PushRegistersAndAdjustStack({}, 0);
+  ABI_CallFunction(CoreTiming::Idle);
+  ABI_PopRegistersAndAdjustStack({}, 0);
+  MOV(32, PPCSTATE(pc), Imm32(destination));
+  WriteExceptionExit();
+}
+
+// Used by branches back to a loop head in the same block. The downcount is only checked here, and
+// the loop keeps running natively while it is positive.
+void Jit64::WriteLoopExit(u32 destination)
+{
+  Cleanup();
+  SUB(32, PPCSTATE(downcount), Imm32(js.downcountAmount));
+  J_CC(CC_G, m_loop_heads.at(destination));
+  // The normal exit reuses the flags of the SUB for its timing check.
+  JustWriteExit(destination, false, 0);
+}
+
 void Jit64::WriteExternalExceptionExit()
 {
   Cleanup();
@@ -706,6 +734,23 @@ void Jit64::Trace()
             fregs.c_str());
 }
 
+void Jit64::Trampoline(Jit64& jit, u32 em_address)
+{
+  // A lot of code only ever runs once or twice (boot code, REL initialization on level loads),
+  // and compiling it stalls the CPU thread for longer than interpreting it would take. Since
+  // native code depends on the state at compile time (speculative constants, GQRs, MSR), it
+  // can't be compiled in the background; instead, the compile is deferred until the block is
+  // missed a second time. The dispatcher only calls this with JITInterpretFirst set.
+  if (!SConfig::GetInstance().bJITNoBlockCache &&
+      jit.js.interpretedAddresses.insert(em_address).second)
+  {
+    PowerPC::ppcState.downcount -= Interpreter::getInstance()->SingleStepBlock();
+    return;
+  }
+
+  JitTrampoline(jit, em_address);
+}
+
 void Jit64::Jit(u32 em_address)
 {
   if (m_cleanup_after_stackfault)
@@ -757,11 +802,40 @@ void Jit64::Jit(u32 em_address)
     }
   }
 
+  // With tiering, blocks are first compiled at a quick tier, which doesn't follow branches or
+  // reorder and merge instructions. Once a block has run TIER_UP_THRESHOLD times, it is
+  // recompiled with all optimizations. The debugger changes the analyzer options itself, so it
+  // gets no tiers.
+  js.quickTier = SConfig::GetInstance().bJITTiering && !SConfig::GetInstance().bEnableDebugging &&
+                 js.tierUpAddresses.find(em_address) == js.tierUpAddresses.end();
+  // Branches back into the block become native loops. The performance monitor and the block
+  // profiler account for whole runs of a block, so they keep the old behaviour.
+  if (SConfig::GetInstance().bJITNativeLoops && !SConfig::GetInstance().bEnableDebugging &&
+      !jo.profile_blocks && !MMCR0.Hex && !MMCR1.Hex)
+  {
+    analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_COMPLEX_BLOCK);
+  }
+  else
+  {
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_COMPLEX_BLOCK);
+  }
+
+  if (js.quickTier)
+  {
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  }
+
   // Analyze the block, collect all instructions it is made of (including inlining,
   // if that is enabled), reorder instructions for optimal performance, and join joinable
   // instructions.
   const u32 nextPC = analyzer.Analyze(em_address, &code_block, &m_code_buffer, block_size);
 
+  if (js.quickTier)
+    EnableOptimization();
+
   if (code_block.m_memory_exception)
   {
     // Address of instruction could not be translated
@@ -787,6 +861,7 @@ u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   js.curBlock = b;
   js.numLoadStoreInst = 0;
   js.numFloatingPointInst = 0;
+  m_loop_heads.clear();
 
   // TODO: Test if this or AlignCode16 make a difference from GetCodePtr
   u8* const start = AlignCode4();
@@ -816,6 +891,25 @@ u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
 #endif
 
+  // Count down the runs of quick tier blocks, and recompile them once they are hot.
+  if (js.quickTier)
+  {
+    b->tierUpCountdown = TIER_UP_THRESHOLD;
+
+    SwitchToFarCode();
+    const u8* tier_up = GetCodePtr();
+    MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+    ABI_PushRegistersAndAdjustStack({}, 0);
+    ABI_CallFunction(JitInterface::TierUpBlock);
+    ABI_PopRegistersAndAdjustStack({}, 0);
+    JMP(asm_routines.dispatcher_no_check, true);
+    SwitchToNearCode();
+
+    MOV(64, R(RSCRATCH), ImmPtr(&b->tierUpCountdown));
+    SUB(32, MatR(RSCRATCH), Imm8(1));
+    J_CC(CC_Z, tier_up);
+  }
+
   // Start up the register allocators
   // They use the information in gpa/fpa to preload commonly used registers.
   gpr.Start();
@@ -875,6 +969,21 @@ u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
     js.instructionNumber = i;
     js.instructionsLeft = (code_block.m_num_instructions - 1) - i;
     const GekkoOPInfo* opinfo = op.opinfo;
+
+    // Loop heads are also entered from their back-edge, which flushes everything and has already
+    // charged the cycles of the instructions before the head.
+    if (op.isBranchTarget)
+    {
+      gpr.Flush();
+      fpr.Flush();
+      if (js.downcountAmount)
+      {
+        SUB(32, PPCSTATE(downcount), Imm32(js.downcountAmount));
+        js.downcountAmount = 0;
+      }
+      m_loop_heads[op.address] = GetCodePtr();
+    }
+
     js.downcountAmount += opinfo->numCycles;
     js.fastmemLoadStore = nullptr;
     js.fixupExceptionHandler = false;
@@ -18,6 +18,8 @@
 // ----------
 #pragma once
 
+#include <map>
+
 #include "Common/CommonTypes.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
@@ -56,6 +58,10 @@ public:
   // Jit!
 
   void Jit(u32 em_address) override;
+  // Called by the dispatcher when no block is found and JITInterpretFirst is set. Runs blocks
+  // which haven't been seen yet through the interpreter, and only compiles them once they're hit
+  // again.
+  static void Trampoline(Jit64& jit, u32 em_address);
   u8* DoJit(u32 em_address, JitBlock* b, u32 nextPC);
 
   BitSet32 CallerSavedRegistersInUse() const;
@@ -83,6 +89,8 @@ public:
   void WriteBLRExit();
   void WriteExceptionExit();
   void WriteExternalExceptionExit();
+  void WriteIdleExit(u32 destination);
+  void WriteLoopExit(u32 destination);
   void WriteRfiExitDestInRSCRATCH();
   bool Cleanup();
 
@@ -253,6 +261,8 @@ private:
 
   bool m_enable_blr_optimization;
   bool m_cleanup_after_stackfault;
+  // Native code of the loop heads in the block being compiled, by guest address.
+  std::map<u32, const u8*> m_loop_heads;
   u8* m_stack;
 };
 
@@ -181,13 +181,30 @@ void Jit64AsmRoutineManager::Generate()
   // otherwise we will generate a second stack overflow exception during DoJit()
   ResetStack(*this);
 
+  // Blocks are only run through the interpreter before they are compiled when asked to, as it
+  // changes timing. The debugger always gets compiled blocks.
+  const bool interpret_first =
+      SConfig::GetInstance().bJITInterpretFirst && !SConfig::GetInstance().bEnableDebugging;
+
   ABI_PushRegistersAndAdjustStack({}, 0);
   MOV(64, R(ABI_PARAM1), Imm64(reinterpret_cast<u64>(&m_jit)));
   MOV(32, R(ABI_PARAM2), PPCSTATE(pc));
-  ABI_CallFunction(JitTrampoline);
+  if (interpret_first)
+    ABI_CallFunction(Jit64::Trampoline);
+  else
+    ABI_CallFunction(JitTrampoline);
   ABI_PopRegistersAndAdjustStack({}, 0);
 
-  JMP(dispatcher_no_check, true);
+  if (!interpret_first)
+  {
+    JMP(dispatcher_no_check, true);
+  }
+  else
+  {
+    // The block may have been run through the interpreter, so check the downcount again.
+    CMP(32, PPCSTATE(downcount), Imm8(0));
+    JMP(dispatcher, true);
+  }
 
   SetJumpTarget(bail);
   do_timing = GetCodePtr();
@@ -96,13 +96,9 @@ void Jit64::bx(UGeckoInstruction inst)
   if (inst.LK)
     AND(32, PPCSTATE(cr), Imm32(~(0xFF000000)));
 #endif
-  if (destination == js.compilerPC)
+  if (destination == js.compilerPC || js.op->branchIsIdleLoop)
   {
-    ABI_PushRegistersAndAdjustStack({}, 0);
-    ABI_CallFunction(CoreTiming::Idle);
-    ABI_PopRegistersAndAdjustStack({}, 0);
-    MOV(32, PPCSTATE(pc), Imm32(destination));
-    WriteExceptionExit();
+    WriteIdleExit(destination);
     return;
   }
   WriteExit(destination, inst.LK, js.compilerPC + 4);
@@ -165,7 +161,12 @@ void Jit64::bcx(UGeckoInstruction inst)
     RCForkGuard fpr_guard = fpr.Fork();
     gpr.Flush();
     fpr.Flush();
-    WriteExit(destination, inst.LK, js.compilerPC + 4);
+    if (js.op->branchIsIdleLoop)
+      WriteIdleExit(destination);
+    else if (js.op->branchTo == destination)
+      WriteLoopExit(destination);
+    else
+      WriteExit(destination, inst.LK, js.compilerPC + 4);
   }
 
   if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
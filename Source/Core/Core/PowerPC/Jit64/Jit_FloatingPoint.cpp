@@ -437,7 +437,15 @@ void Jit64::fselx(UGeckoInstruction inst)
   else
     CMPSD(XMM0, Ra, CMP_NLE);
 
-  if (cpu_info.bSSE4_1)
+  if (cpu_info.bAVX && Rc.IsSimpleReg())
+  {
+    // The VEX form takes the mask as an explicit operand, so a packed select can blend straight
+    // into the destination register.
+    VBLENDVPD(packed ? Rd : XMM1, Rc.GetSimpleReg(), Rb, XMM0);
+    if (packed)
+      return;
+  }
+  else if (cpu_info.bSSE4_1)
   {
     MOVAPD(XMM1, Rc);
     BLENDVPD(XMM1, Rb);
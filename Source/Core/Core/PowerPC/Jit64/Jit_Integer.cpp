@@ -371,7 +371,12 @@ void Jit64::DoMergedBranch()
       destination = SignExt16(next.BD << 2);
     else
       destination = nextPC + SignExt16(next.BD << 2);
-    WriteExit(destination, next.LK, nextPC + 4);
+    if (js.op[1].branchIsIdleLoop)
+      WriteIdleExit(destination);
+    else if (js.op[1].branchTo == destination)
+      WriteLoopExit(destination);
+    else
+      WriteExit(destination, next.LK, nextPC + 4);
   }
   else if ((next.OPCD == 19) && (next.SUBOP10 == 528))  // bcctrx
   {
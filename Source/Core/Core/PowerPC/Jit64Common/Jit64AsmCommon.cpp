@@ -321,6 +321,22 @@ const u8* CommonAsmRoutines::GenQuantizedLoadRuntime(bool single, EQuantizeType
   return load;
 }
 
+// Multiplies both lanes in XMM0 by a pair of (de)quantization scales. The upper half of XMM0 is
+// always zero here, so the AVX form can read the scales straight from the padded table without
+// changing the result.
+void QuantizedMemoryRoutines::MultiplyByScale(const OpArg& scale)
+{
+  if (cpu_info.bAVX)
+  {
+    VMULPS(XMM0, XMM0, scale);
+  }
+  else
+  {
+    MOVQ_xmm(XMM1, scale);
+    MULPS(XMM0, R(XMM1));
+  }
+}
+
 void QuantizedMemoryRoutines::GenQuantizedStore(bool single, EQuantizeType type, int quantize)
 {
   // In: one or two single floats in XMM0, if quantize is -1, a quantization factor in RSCRATCH2
@@ -384,13 +400,11 @@ void QuantizedMemoryRoutines::GenQuantizedStore(bool single, EQuantizeType type,
     {
       SHR(32, R(RSCRATCH2), Imm8(5));
       LEA(64, RSCRATCH, MConst(m_quantizeTableS));
-      MOVQ_xmm(XMM1, MRegSum(RSCRATCH2, RSCRATCH));
-      MULPS(XMM0, R(XMM1));
+      MultiplyByScale(MRegSum(RSCRATCH2, RSCRATCH));
     }
     else if (quantize > 0)
     {
-      MOVQ_xmm(XMM1, MConst(m_quantizeTableS, quantize * 2));
-      MULPS(XMM0, R(XMM1));
+      MultiplyByScale(MConst(m_quantizeTableS, quantize * 2));
     }
 
     bool hasPACKUSDW = cpu_info.bSSE4_1;
@@ -617,13 +631,11 @@ void QuantizedMemoryRoutines::GenQuantizedLoad(bool single, EQuantizeType type,
     {
       SHR(32, R(RSCRATCH2), Imm8(5));
       LEA(64, RSCRATCH, MConst(m_dequantizeTableS));
-      MOVQ_xmm(XMM1, MRegSum(RSCRATCH2, RSCRATCH));
-      MULPS(XMM0, R(XMM1));
+      MultiplyByScale(MRegSum(RSCRATCH2, RSCRATCH));
     }
     else if (quantize > 0)
     {
-      MOVQ_xmm(XMM1, MConst(m_dequantizeTableS, quantize * 2));
-      MULPS(XMM0, R(XMM1));
+      MultiplyByScale(MConst(m_dequantizeTableS, quantize * 2));
     }
   }
 }
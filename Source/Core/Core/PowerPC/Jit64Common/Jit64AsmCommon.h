@@ -20,6 +20,7 @@ public:
 private:
   void GenQuantizedLoadFloat(bool single, bool isInline);
   void GenQuantizedStoreFloat(bool single, bool isInline);
+  void MultiplyByScale(const Gen::OpArg& scale);
 };
 
 class CommonAsmRoutines : public CommonAsmRoutinesBase, public QuantizedMemoryRoutines
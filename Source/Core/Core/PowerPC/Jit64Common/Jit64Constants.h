@@ -6,6 +6,7 @@
 
 #include <cstddef>
 
+#include "Common/CommonTypes.h"
 #include "Common/x64Reg.h"
 
 // RSCRATCH and RSCRATCH2 are always scratch registers and can be used without
@@ -22,3 +23,7 @@ constexpr Gen::X64Reg RMEM = Gen::RBX;
 constexpr Gen::X64Reg RPPCSTATE = Gen::RBP;
 
 constexpr size_t CODE_SIZE = 1024 * 1024 * 32;
+
+// Number of runs after which a block compiled at the quick tier is recompiled with all
+// optimizations.
+constexpr u32 TIER_UP_THRESHOLD = 1000;
@@ -300,6 +300,14 @@ bool JitArm64::HandleFastmemFault(uintptr_t access_address, SContext* ctx)
     return false;
   }
 
+  // Pages from the page table get mapped on their first access, after which it can be retried.
+  const uintptr_t logical_base = (uintptr_t)Memory::logical_base;
+  if (access_address >= logical_base && access_address < logical_base + 0x100000000 &&
+      PowerPC::HandleFastmemPageFault(static_cast<u32>(access_address - logical_base)))
+  {
+    return true;
+  }
+
   auto slow_handler_iter = m_fault_to_handler.upper_bound((const u8*)ctx->CTX_PC);
   slow_handler_iter--;
 
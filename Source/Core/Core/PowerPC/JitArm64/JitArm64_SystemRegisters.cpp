@@ -117,6 +117,8 @@ void JitArm64::mtsr(UGeckoInstruction inst)
 {
   INSTRUCTION_START
   JITDISABLE(bJITSystemRegistersOff);
+  // Changing a segment has to unmap the fastmem pages translated through it.
+  FALLBACK_IF(SConfig::GetInstance().bPageTableFastmem);
 
   gpr.BindToRegister(inst.RS, true);
   STR(INDEX_UNSIGNED, gpr.R(inst.RS), PPC_REG, PPCSTATE_OFF(sr[inst.SR]));
@@ -145,6 +147,7 @@ void JitArm64::mtsrin(UGeckoInstruction inst)
 {
   INSTRUCTION_START
   JITDISABLE(bJITSystemRegistersOff);
+  FALLBACK_IF(SConfig::GetInstance().bPageTableFastmem);
 
   u32 b = inst.RB, d = inst.RD;
   gpr.BindToRegister(d, d == b);
@@ -9,8 +9,10 @@
 alignas(16) extern const u8 pbswapShuffle1x4[16];
 alignas(16) extern const u8 pbswapShuffle2x4[16];
 alignas(16) extern const float m_one[4];
-alignas(16) extern const float m_quantizeTableS[128];
-alignas(16) extern const float m_dequantizeTableS[128];
+// The quantization tables hold each scale twice, once per paired single lane. They are padded by
+// one pair so that a 16-byte AVX memory operand on the last entry stays inside the array.
+alignas(16) extern const float m_quantizeTableS[130];
+alignas(16) extern const float m_dequantizeTableS[130];
 
 struct CommonAsmRoutinesBase
 {
@@ -18,6 +18,7 @@ const u8* JitBase::Dispatch(JitBase& jit)
 void JitTrampoline(JitBase& jit, u32 em_address)
 {
   jit.Jit(em_address);
+  jit.GetBlockCache()->CompileWarmStartBlocks();
 }
 
 JitBase::JitBase() : m_code_buffer(code_buffer_size)
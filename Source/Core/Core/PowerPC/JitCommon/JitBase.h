@@ -71,6 +71,8 @@ protected:
     std::map<u8, u32> constantGqr;
     bool firstFPInstructionFound;
     bool isLastInstruction;
+    // Set while compiling a block at the quick tier, see Jit64::Jit.
+    bool quickTier;
     int skipInstructions;
     bool carryFlagSet;
     bool carryFlagInverted;
@@ -91,6 +93,11 @@ protected:
     std::unordered_set<u32> fifoWriteAddresses;
     std::unordered_set<u32> pairedQuantizeAddresses;
     std::unordered_set<u32> noSpeculativeConstantsAddresses;
+    // Blocks which got hot at the quick tier and are compiled with all optimizations.
+    std::unordered_set<u32> tierUpAddresses;
+    // Blocks which have already been run once through the interpreter and get compiled on
+    // their next miss.
+    std::unordered_set<u32> interpretedAddresses;
   };
 
   PPCAnalyst::CodeBlock code_block;
@@ -15,12 +15,22 @@
 #include <functional>
 #include <map>
 #include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
 #include "Common/JitRegister.h"
+#include "Common/Logging/Log.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/HW/SystemTimers.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/MMU.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
@@ -32,10 +42,129 @@
 
 using namespace Gen;
 
+// Warm start profiles store every block compiled for a game, so that the next session can
+// compile them before they are first hit.
+static constexpr u32 WARM_START_MAGIC = 0x5357504A;  // "JPWS"
+static constexpr u32 WARM_START_VERSION = 1;
+// Only this many instructions from the entry point of a block are hashed.
+static constexpr u32 WARM_START_MAX_HASHED_INSTRUCTIONS = 64;
+static constexpr size_t WARM_START_MAX_BLOCKS = 0x10000;
+// Limits on the work done per dispatcher miss, so that the warm start doesn't cause stutter itself.
+static constexpr u32 WARM_START_EXAMINED_PER_MISS = 64;
+static constexpr u32 WARM_START_COMPILED_PER_MISS = 16;
+// Blocks whose code isn't in RAM yet (e.g. in RELs that are loaded later) are retried for
+// this long before they are dropped from the profile.
+static constexpr u32 WARM_START_RETRY_SECONDS = 60;
+
+struct WarmStartHeader
+{
+  u32 magic;
+  u32 version;
+  u32 num_entries;
+};
+
+static std::string GetWarmStartProfilePath()
+{
+  const std::string& game_id = SConfig::GetInstance().GetGameID();
+  if (game_id.empty())
+    return {};
+  return File::GetUserPath(D_CACHE_IDX) + "JitProfiles" DIR_SEP + game_id + ".bin";
+}
+
+// Hashes the guest code a block was compiled from, starting at its physical entry point.
+static bool HashBlockCode(u32 physical_address, u32 num_instructions, u32* hash)
+{
+  const u32 size = std::min(num_instructions, WARM_START_MAX_HASHED_INSTRUCTIONS) * sizeof(u32);
+  const u32 address = physical_address & 0x3FFFFFFF;
+
+  const u8* code = nullptr;
+  if (address + size <= Memory::REALRAM_SIZE)
+    code = Memory::m_pRAM + address;
+  else if (Memory::m_pEXRAM && (address >> 28) == 0x1 &&
+           (address & 0x0FFFFFFF) + size <= Memory::EXRAM_SIZE)
+    code = Memory::m_pEXRAM + (address & 0x0FFFFFFF);
+
+  if (!code || size == 0)
+    return false;
+
+  *hash = Common::HashAdler32(code, size);
+  return true;
+}
+
 bool JitBlock::OverlapsPhysicalRange(u32 address, u32 length) const
 {
-  return physical_addresses.lower_bound(address) !=
-         physical_addresses.lower_bound(address + length);
+  return std::lower_bound(physical_addresses.begin(), physical_addresses.end(), address) !=
+         std::lower_bound(physical_addresses.begin(), physical_addresses.end(), address + length);
+}
+
+void JitBlockTable::Insert(u64 key, JitBlock* block)
+{
+  if ((m_used + 1) * 4 > m_entries.size() * 3)
+  {
+    // Grow if the table is mostly in use, otherwise just get rid of the deleted entries.
+    Rehash(std::max<size_t>(MIN_CAPACITY, (m_size + 1) * 2 > m_entries.size() ?
+                                              m_entries.size() * 2 :
+                                              m_entries.size()));
+  }
+
+  for (size_t i = Hash(key);; i = (i + 1) & m_mask)
+  {
+    Entry& entry = m_entries[i];
+    if (entry.block == nullptr)
+    {
+      if (entry.key != DELETED_KEY)
+        m_used++;
+      entry.key = key;
+      entry.block = block;
+      m_size++;
+      return;
+    }
+  }
+}
+
+void JitBlockTable::Erase(u64 key, const JitBlock* block)
+{
+  if (m_entries.empty())
+    return;
+
+  for (size_t i = Hash(key);; i = (i + 1) & m_mask)
+  {
+    Entry& entry = m_entries[i];
+    if (entry.block == nullptr)
+    {
+      if (entry.key != DELETED_KEY)
+        return;
+    }
+    else if (entry.key == key && entry.block == block)
+    {
+      entry.key = DELETED_KEY;
+      entry.block = nullptr;
+      m_size--;
+      return;
+    }
+  }
+}
+
+void JitBlockTable::Clear()
+{
+  std::fill(m_entries.begin(), m_entries.end(), Entry());
+  m_size = 0;
+  m_used = 0;
+}
+
+void JitBlockTable::Rehash(size_t capacity)
+{
+  std::vector<Entry> old_entries(capacity);
+  std::swap(old_entries, m_entries);
+  m_mask = capacity - 1;
+  m_size = 0;
+  m_used = 0;
+
+  for (const Entry& entry : old_entries)
+  {
+    if (entry.block)
+      Insert(entry.key, entry.block);
+  }
 }
 
 JitBaseBlockCache::JitBaseBlockCache(JitBase& jit) : m_jit{jit}
@@ -48,11 +177,22 @@ void JitBaseBlockCache::Init()
 {
   JitRegister::Init(SConfig::GetInstance().m_perfDir);
 
+  m_warm_start_enabled = SConfig::GetInstance().bJITWarmStart &&
+                         !SConfig::GetInstance().bJITNoBlockCache &&
+                         !SConfig::GetInstance().bEnableDebugging;
+  m_warm_start_loaded = false;
+  m_warm_start_profile.clear();
+  m_warm_start_queue.clear();
+  m_retired_profiles.clear();
+
   Clear();
 }
 
 void JitBaseBlockCache::Shutdown()
 {
+  if (m_warm_start_loaded)
+    SaveWarmStartProfile();
+
   JitRegister::Shutdown();
 }
 
@@ -65,12 +205,12 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
-  for (auto& e : block_map)
-  {
-    DestroyBlock(e.second);
-  }
-  block_map.clear();
-  links_to.clear();
+  m_jit.js.tierUpAddresses.clear();
+  m_jit.js.interpretedAddresses.clear();
+  block_map.ForEach([this](JitBlock* block) { DestroyBlock(*block); });
+  block_map.ForEach([this](JitBlock* block) { FreeBlock(block); });
+  block_map.Clear();
+  links_to.Clear();
   block_range_map.clear();
 
   valid_block.ClearAll();
@@ -91,19 +231,54 @@ JitBlock** JitBaseBlockCache::GetFastBlockMap()
 
 void JitBaseBlockCache::RunOnBlocks(std::function<void(const JitBlock&)> f)
 {
-  for (const auto& e : block_map)
-    f(e.second);
+  block_map.ForEach([&f](const JitBlock* block) { f(*block); });
+}
+
+void JitBaseBlockCache::RunOnRetiredProfiles(
+    std::function<void(u32, u32, const JitBlock::ProfileData&)> f) const
+{
+  for (const auto& e : m_retired_profiles)
+    f(e.first, e.second.code_size, e.second.data);
+}
+
+void JitBaseBlockCache::ClearRetiredProfiles()
+{
+  m_retired_profiles.clear();
+}
+
+JitBlock* JitBaseBlockCache::NewBlock()
+{
+  if (free_blocks.empty())
+  {
+    block_slabs.emplace_back(std::make_unique<JitBlock[]>(BLOCK_SLAB_SIZE));
+    JitBlock* slab = block_slabs.back().get();
+    for (size_t i = BLOCK_SLAB_SIZE; i > 0; i--)
+      free_blocks.push_back(&slab[i - 1]);
+  }
+
+  JitBlock* block = free_blocks.back();
+  free_blocks.pop_back();
+  return block;
+}
+
+void JitBaseBlockCache::FreeBlock(JitBlock* block)
+{
+  free_blocks.push_back(block);
 }
 
 JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
   u32 physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
-  JitBlock& b = block_map.emplace(physicalAddress, JitBlock())->second;
+  JitBlock& b = *NewBlock();
   b.effectiveAddress = em_address;
   b.physicalAddress = physicalAddress;
   b.msrBits = MSR.Hex & JIT_CACHE_MSR_MASK;
   b.linkData.clear();
+  b.physical_addresses.clear();
+  b.profile_data = {};
+  b.tierUpCountdown = 0;
   b.fast_block_map_index = 0;
+  block_map.Insert(BlockKey(em_address, b.msrBits), &b);
   return &b;
 }
 
@@ -114,25 +289,36 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
   fast_block_map[index] = &block;
   block.fast_block_map_index = index;
 
-  block.physical_addresses = physical_addresses;
+  block.physical_addresses.assign(physical_addresses.begin(), physical_addresses.end());
 
   u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  std::vector<JitBlock*>* range = nullptr;
+  u32 range_start = 0;
   for (u32 addr : physical_addresses)
   {
     valid_block.Set(addr / 32);
-    block_range_map[addr & range_mask].insert(&block);
+    // The addresses are sorted, so each macro block only needs to be looked up once.
+    if (!range || (addr & range_mask) != range_start)
+    {
+      range_start = addr & range_mask;
+      range = &block_range_map[range_start];
+      range->push_back(&block);
+    }
   }
 
   if (block_link)
   {
     for (const auto& e : block.linkData)
     {
-      links_to.emplace(e.exitAddress, &block);
+      links_to.Insert(e.exitAddress, &block);
     }
 
     LinkBlock(block);
   }
 
+  if (m_warm_start_enabled)
+    RecordWarmStartBlock(block);
+
   Common::Symbol* symbol = nullptr;
   if (JitRegister::IsEnabled() &&
       (symbol = g_symbolDB.GetSymbolFromAddr(block.effectiveAddress)) != nullptr)
@@ -160,15 +346,9 @@ JitBlock* JitBaseBlockCache::GetBlockFromStartAddress(u32 addr, u32 msr)
     translated_addr = translated.address;
   }
 
-  auto iter = block_map.equal_range(translated_addr);
-  for (; iter.first != iter.second; iter.first++)
-  {
-    JitBlock& b = iter.first->second;
-    if (b.effectiveAddress == addr && b.msrBits == (msr & JIT_CACHE_MSR_MASK))
-      return &b;
-  }
-
-  return nullptr;
+  return block_map.Find(BlockKey(addr, msr & JIT_CACHE_MSR_MASK), [translated_addr](JitBlock* b) {
+    return b->physicalAddress == translated_addr;
+  });
 }
 
 const u8* JitBaseBlockCache::Dispatch()
@@ -216,6 +396,8 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
       {
         m_jit.js.fifoWriteAddresses.erase(i);
         m_jit.js.pairedQuantizeAddresses.erase(i);
+        m_jit.js.tierUpAddresses.erase(i);
+        m_jit.js.interpretedAddresses.erase(i);
       }
     }
   }
@@ -223,51 +405,85 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
 
 void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
 {
-  // Iterate over all macro blocks which overlap the given range.
+  if (length == 0)
+    return;
+
   u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  auto start = block_range_map.lower_bound(address & range_mask);
-  auto end = block_range_map.lower_bound(address + length);
-  while (start != end)
-  {
+  const auto erase_from_range = [&](u32 range) {
+    auto iter = block_range_map.find(range);
+    if (iter == block_range_map.end())
+      return;
+
     // Iterate over all blocks in the macro block.
-    auto iter = start->second.begin();
-    while (iter != start->second.end())
+    std::vector<JitBlock*>& blocks = iter->second;
+    for (size_t i = 0; i < blocks.size();)
     {
-      JitBlock* block = *iter;
-      if (block->OverlapsPhysicalRange(address, length))
+      JitBlock* block = blocks[i];
+      if (!block->OverlapsPhysicalRange(address, length))
       {
-        // If the block overlaps, also remove all other occupied slots in the other macro blocks.
-        // This will leak empty macro blocks, but they may be reused or cleared later on.
-        for (u32 addr : block->physical_addresses)
-          if ((addr & range_mask) != start->first)
-            block_range_map[addr & range_mask].erase(block);
-
-        // And remove the block.
-        DestroyBlock(*block);
-        auto block_map_iter = block_map.equal_range(block->physicalAddress);
-        while (block_map_iter.first != block_map_iter.second)
-        {
-          if (&block_map_iter.first->second == block)
-          {
-            block_map.erase(block_map_iter.first);
-            break;
-          }
-          block_map_iter.first++;
-        }
-        iter = start->second.erase(iter);
+        i++;
+        continue;
       }
-      else
+
+      // If the block overlaps, also remove it from the other macro blocks it occupies.
+      u32 previous_range = range;
+      for (u32 addr : block->physical_addresses)
       {
-        iter++;
+        if ((addr & range_mask) != previous_range && (addr & range_mask) != range)
+          RemoveFromRange(addr & range_mask, block);
+        previous_range = addr & range_mask;
       }
+
+      // And remove the block.
+      DestroyBlock(*block);
+      block_map.Erase(BlockKey(block->effectiveAddress, block->msrBits), block);
+      FreeBlock(block);
+      blocks[i] = blocks.back();
+      blocks.pop_back();
     }
 
     // If the macro block is empty, drop it.
-    if (start->second.empty())
-      start = block_range_map.erase(start);
-    else
-      start++;
+    if (blocks.empty())
+      block_range_map.erase(iter);
+  };
+
+  // Iterate over all macro blocks which overlap the given range. For large ranges, it's
+  // cheaper to look at the macro blocks that actually exist.
+  const u64 first_range = address & range_mask;
+  const u64 end = static_cast<u64>(address) + length;
+  if ((end - first_range) / BLOCK_RANGE_MAP_ELEMENTS > block_range_map.size())
+  {
+    std::vector<u32> ranges;
+    for (const auto& e : block_range_map)
+    {
+      if (e.first >= first_range && e.first < end)
+        ranges.push_back(e.first);
+    }
+    for (u32 range : ranges)
+      erase_from_range(range);
+  }
+  else
+  {
+    for (u64 range = first_range; range < end; range += BLOCK_RANGE_MAP_ELEMENTS)
+      erase_from_range(static_cast<u32>(range));
+  }
+}
+
+void JitBaseBlockCache::RemoveFromRange(u32 range, const JitBlock* block)
+{
+  auto iter = block_range_map.find(range);
+  if (iter == block_range_map.end())
+    return;
+
+  std::vector<JitBlock*>& blocks = iter->second;
+  auto block_iter = std::find(blocks.begin(), blocks.end(), block);
+  if (block_iter != blocks.end())
+  {
+    *block_iter = blocks.back();
+    blocks.pop_back();
   }
+  if (blocks.empty())
+    block_range_map.erase(iter);
 }
 
 u32* JitBaseBlockCache::GetBlockBitSet() const
@@ -304,14 +520,10 @@ void JitBaseBlockCache::LinkBlockExits(JitBlock& block)
 void JitBaseBlockCache::LinkBlock(JitBlock& block)
 {
   LinkBlockExits(block);
-  auto ppp = links_to.equal_range(block.effectiveAddress);
-
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
-  {
-    JitBlock& b2 = *iter->second;
-    if (block.msrBits == b2.msrBits)
-      LinkBlockExits(b2);
-  }
+  links_to.ForEach(block.effectiveAddress, [this, &block](JitBlock* b2) {
+    if (block.msrBits == b2->msrBits)
+      LinkBlockExits(*b2);
+  });
 }
 
 void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
@@ -323,14 +535,11 @@ void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
   }
 
   // Unlink all exits of other blocks which points to this block
-  auto ppp = links_to.equal_range(block.effectiveAddress);
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
-  {
-    JitBlock& sourceBlock = *iter->second;
-    if (sourceBlock.msrBits != block.msrBits)
-      continue;
+  links_to.ForEach(block.effectiveAddress, [this, &block](JitBlock* sourceBlock) {
+    if (sourceBlock->msrBits != block.msrBits)
+      return;
 
-    for (auto& e : sourceBlock.linkData)
+    for (auto& e : sourceBlock->linkData)
     {
       if (e.exitAddress == block.effectiveAddress)
       {
@@ -338,7 +547,7 @@ void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
         e.linkStatus = false;
       }
     }
-  }
+  });
 }
 
 void JitBaseBlockCache::DestroyBlock(JitBlock& block)
@@ -351,14 +560,16 @@ void JitBaseBlockCache::DestroyBlock(JitBlock& block)
   // Delete linking addresses
   for (const auto& e : block.linkData)
   {
-    auto it = links_to.equal_range(e.exitAddress);
-    while (it.first != it.second)
-    {
-      if (it.first->second == &block)
-        it.first = links_to.erase(it.first);
-      else
-        it.first++;
-    }
+    links_to.Erase(e.exitAddress, &block);
+  }
+
+  if (m_jit.jo.profile_blocks && block.profile_data.runCount)
+  {
+    RetiredProfile& retired = m_retired_profiles[block.effectiveAddress];
+    retired.data.ticCounter += block.profile_data.ticCounter;
+    retired.data.downcountCounter += block.profile_data.downcountCounter;
+    retired.data.runCount += block.profile_data.runCount;
+    retired.code_size = block.codeSize;
   }
 
   // Raise an signal if we are going to call this block again
@@ -388,3 +599,175 @@ size_t JitBaseBlockCache::FastLookupIndexForAddress(u32 address)
 {
   return (address >> 2) & FAST_BLOCK_MAP_MASK;
 }
+
+void JitBaseBlockCache::RecordWarmStartBlock(const JitBlock& block)
+{
+  u32 hash;
+  if (!HashBlockCode(block.physicalAddress, block.originalSize, &hash))
+    return;
+
+  const u64 key = BlockKey(block.effectiveAddress, block.msrBits);
+  WarmStartEntry& entry = m_warm_start_profile[key];
+  entry.effective_address = block.effectiveAddress;
+  entry.msr_bits = block.msrBits;
+  entry.physical_address = block.physicalAddress;
+  entry.num_instructions = block.originalSize;
+  entry.code_hash = hash;
+  // Blocks that get compiled again after being invalidated are usually hot.
+  if (entry.hits != UINT32_MAX)
+    entry.hits++;
+}
+
+void JitBaseBlockCache::LoadWarmStartProfile()
+{
+  m_warm_start_loaded = true;
+  m_warm_start_position = 0;
+  m_warm_start_deadline =
+      CoreTiming::GetTicks() + static_cast<u64>(SystemTimers::GetTicksPerSecond()) *
+                                   WARM_START_RETRY_SECONDS;
+
+  const std::string path = GetWarmStartProfilePath();
+  if (path.empty())
+    return;
+
+  File::IOFile file(path, "rb");
+  WarmStartHeader header;
+  if (!file || !file.ReadArray(&header, 1) || header.magic != WARM_START_MAGIC ||
+      header.version != WARM_START_VERSION || header.num_entries > WARM_START_MAX_BLOCKS)
+  {
+    return;
+  }
+
+  std::vector<WarmStartEntry> entries(header.num_entries);
+  if (!file.ReadArray(entries.data(), entries.size()))
+    return;
+
+  for (const WarmStartEntry& entry : entries)
+  {
+    const u64 key = BlockKey(entry.effective_address, entry.msr_bits);
+    m_warm_start_profile.emplace(key, entry);
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const WarmStartEntry& a, const WarmStartEntry& b) { return a.hits > b.hits; });
+  m_warm_start_queue = std::move(entries);
+
+  INFO_LOG(DYNA_REC, "Loaded %zu blocks from warm start profile %s", m_warm_start_queue.size(),
+           path.c_str());
+}
+
+void JitBaseBlockCache::SaveWarmStartProfile()
+{
+  const std::string path = GetWarmStartProfilePath();
+  if (path.empty() || m_warm_start_profile.empty())
+    return;
+
+  std::vector<WarmStartEntry> entries;
+  entries.reserve(m_warm_start_profile.size());
+  for (const auto& e : m_warm_start_profile)
+    entries.push_back(e.second);
+
+  // The run counts of the block profiler are a better measure of hotness, when available.
+  if (m_jit.jo.profile_blocks)
+  {
+    std::unordered_map<u64, u64> run_counts;
+    block_map.ForEach([&run_counts](const JitBlock* block) {
+      run_counts[BlockKey(block->effectiveAddress, block->msrBits)] += block->profile_data.runCount;
+    });
+    for (WarmStartEntry& entry : entries)
+    {
+      const auto it = run_counts.find(BlockKey(entry.effective_address, entry.msr_bits));
+      if (it != run_counts.end())
+        entry.hits = static_cast<u32>(std::min<u64>(entry.hits + it->second, UINT32_MAX));
+    }
+  }
+
+  if (entries.size() > WARM_START_MAX_BLOCKS)
+  {
+    std::partial_sort(
+        entries.begin(), entries.begin() + WARM_START_MAX_BLOCKS, entries.end(),
+        [](const WarmStartEntry& a, const WarmStartEntry& b) { return a.hits > b.hits; });
+    entries.resize(WARM_START_MAX_BLOCKS);
+  }
+
+  File::CreateFullPath(path);
+  File::IOFile file(path, "wb");
+  const WarmStartHeader header = {WARM_START_MAGIC, WARM_START_VERSION,
+                                  static_cast<u32>(entries.size())};
+  if (!file || !file.WriteArray(&header, 1) || !file.WriteArray(entries.data(), entries.size()))
+  {
+    ERROR_LOG(DYNA_REC, "Failed to write warm start profile %s", path.c_str());
+    return;
+  }
+
+  INFO_LOG(DYNA_REC, "Saved %zu blocks to warm start profile %s", entries.size(), path.c_str());
+}
+
+void JitBaseBlockCache::CompileWarmStartBlocks()
+{
+  if (!m_warm_start_enabled)
+    return;
+
+  if (!m_warm_start_loaded)
+    LoadWarmStartProfile();
+
+  if (m_warm_start_queue.empty())
+    return;
+
+  const u32 msr_bits = MSR.Hex & JIT_CACHE_MSR_MASK;
+  const bool retry_expired = CoreTiming::GetTicks() > m_warm_start_deadline;
+
+  u32 examined = 0;
+  u32 compiled = 0;
+  while (examined < WARM_START_EXAMINED_PER_MISS && compiled < WARM_START_COMPILED_PER_MISS)
+  {
+    // Compact the queue whenever we went through all of it.
+    if (m_warm_start_position >= m_warm_start_queue.size())
+    {
+      m_warm_start_queue.erase(
+          std::remove_if(m_warm_start_queue.begin(), m_warm_start_queue.end(),
+                         [](const WarmStartEntry& entry) { return entry.hits == 0; }),
+          m_warm_start_queue.end());
+      m_warm_start_position = 0;
+      if (m_warm_start_queue.empty())
+        break;
+    }
+
+    WarmStartEntry& entry = m_warm_start_queue[m_warm_start_position++];
+    if (entry.hits == 0)
+      continue;
+    examined++;
+
+    // Blocks can only be compiled for the current address translation mode.
+    if (entry.msr_bits != msr_bits && !retry_expired)
+      continue;
+
+    if (entry.msr_bits == msr_bits && !GetBlockFromStartAddress(entry.effective_address, msr_bits))
+    {
+      const auto translated = PowerPC::JitCache_TranslateAddress(entry.effective_address);
+      u32 hash;
+      const bool code_matches = translated.valid &&
+                                translated.address == entry.physical_address &&
+                                HashBlockCode(entry.physical_address, entry.num_instructions,
+                                              &hash) &&
+                                hash == entry.code_hash;
+      if (code_matches)
+      {
+        m_jit.Jit(entry.effective_address);
+        compiled++;
+      }
+      else if (!retry_expired)
+      {
+        continue;
+      }
+      else
+      {
+        // The game doesn't have this code at this address anymore.
+        m_warm_start_profile.erase(BlockKey(entry.effective_address, entry.msr_bits));
+      }
+    }
+
+    // Mark the entry as done.
+    entry.hits = 0;
+  }
+}
@@ -8,9 +8,9 @@
 #include <bitset>
 #include <cstring>
 #include <functional>
-#include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -61,8 +61,8 @@ struct JitBlock
   };
   std::vector<LinkData> linkData;
 
-  // This set stores all physical addresses of all occupied instructions.
-  std::set<u32> physical_addresses;
+  // The sorted physical addresses of all occupied instructions.
+  std::vector<u32> physical_addresses;
 
   // Block profiling data, structure is inlined in Jit.cpp
   struct ProfileData
@@ -74,6 +74,10 @@ struct JitBlock
     u64 ticStop;
   } profile_data = {};
 
+  // Blocks compiled at the quick tier count down their runs, and are recompiled with all
+  // optimizations once this reaches zero.
+  u32 tierUpCountdown;
+
   // This tracks the position if this block within the fast block cache.
   // We allow each block to have only one map entry.
   size_t fast_block_map_index;
@@ -81,6 +85,83 @@ struct JitBlock
 
 typedef void (*CompiledCode)();
 
+// Open addressing hash table from 64-bit keys to blocks. Like a multimap, a key may be
+// inserted several times with different blocks.
+class JitBlockTable final
+{
+public:
+  void Insert(u64 key, JitBlock* block);
+  void Erase(u64 key, const JitBlock* block);
+  void Clear();
+  size_t Size() const { return m_size; }
+
+  // Calls f for every block with the given key. Returns the first block for which f returns true.
+  template <typename F>
+  JitBlock* Find(u64 key, F f) const
+  {
+    if (m_entries.empty())
+      return nullptr;
+
+    for (size_t i = Hash(key);; i = (i + 1) & m_mask)
+    {
+      const Entry& entry = m_entries[i];
+      if (entry.block == nullptr)
+      {
+        if (entry.key != DELETED_KEY)
+          return nullptr;
+      }
+      else if (entry.key == key && f(entry.block))
+      {
+        return entry.block;
+      }
+    }
+  }
+
+  // Calls f for every block with the given key.
+  template <typename F>
+  void ForEach(u64 key, F f) const
+  {
+    Find(key, [&f](JitBlock* block) {
+      f(block);
+      return false;
+    });
+  }
+
+  // Calls f for every entry in the table.
+  template <typename F>
+  void ForEach(F f) const
+  {
+    for (const Entry& entry : m_entries)
+    {
+      if (entry.block)
+        f(entry.block);
+    }
+  }
+
+private:
+  struct Entry
+  {
+    u64 key = 0;
+    // nullptr for empty and deleted entries, which are told apart by their key.
+    JitBlock* block = nullptr;
+  };
+
+  static constexpr u64 DELETED_KEY = ~0ULL;
+  static constexpr size_t MIN_CAPACITY = 0x400;
+
+  size_t Hash(u64 key) const
+  {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+  }
+  void Rehash(size_t capacity);
+
+  std::vector<Entry> m_entries;
+  size_t m_mask = 0;
+  size_t m_size = 0;
+  // Number of entries which are in use or deleted.
+  size_t m_used = 0;
+};
+
 // This is essentially just an std::bitset, but Visual Studia 2013's
 // implementation of std::bitset is slow.
 class ValidBlockBitSet final
@@ -133,6 +214,11 @@ public:
   JitBlock** GetFastBlockMap();
   void RunOnBlocks(std::function<void(const JitBlock&)> f);
 
+  // Calls f with the entry address, code size and profile data of the blocks that were destroyed
+  // while profiling, merged by entry address.
+  void RunOnRetiredProfiles(std::function<void(u32, u32, const JitBlock::ProfileData&)> f) const;
+  void ClearRetiredProfiles();
+
   JitBlock* AllocateBlock(u32 em_address);
   void FinalizeBlock(JitBlock& block, bool block_link, const std::set<u32>& physical_addresses);
 
@@ -152,13 +238,39 @@ public:
 
   u32* GetBlockBitSet() const;
 
+  // Compiles some of the blocks recorded in the warm start profile of the running game, so that
+  // they don't have to be compiled when they are first hit. Called from JitTrampoline.
+  void CompileWarmStartBlocks();
+
 protected:
   JitBase& m_jit;
 
 private:
+  // A block compiled in an earlier session of the running game.
+  struct WarmStartEntry
+  {
+    u32 effective_address;
+    u32 msr_bits;
+    u32 physical_address;
+    u32 num_instructions;
+    u32 code_hash;
+    u32 hits;
+  };
+
+  // Profile data of destroyed blocks, so that recompiled blocks keep their history.
+  struct RetiredProfile
+  {
+    JitBlock::ProfileData data;
+    u32 code_size;
+  };
+
   virtual void WriteLinkBlock(const JitBlock::LinkData& source, const JitBlock* dest) = 0;
   virtual void WriteDestroyBlock(const JitBlock& block);
 
+  JitBlock* NewBlock();
+  void FreeBlock(JitBlock* block);
+  void RemoveFromRange(u32 range, const JitBlock* block);
+
   void LinkBlockExits(JitBlock& block);
   void LinkBlock(JitBlock& block);
   void UnlinkBlock(const JitBlock& block);
@@ -169,19 +281,33 @@ private:
   // Fast but risky block lookup based on fast_block_map.
   size_t FastLookupIndexForAddress(u32 address);
 
+  void RecordWarmStartBlock(const JitBlock& block);
+  void LoadWarmStartProfile();
+  void SaveWarmStartProfile();
+
+  static u64 BlockKey(u32 em_address, u32 msr_bits)
+  {
+    return static_cast<u64>(msr_bits) << 32 | em_address;
+  }
+
   // links_to hold all exit points of all valid blocks in a reverse way.
   // It is used to query all blocks which links to an address.
-  std::multimap<u32, JitBlock*> links_to;  // destination_PC -> number
+  JitBlockTable links_to;  // destination_PC -> number
 
-  // Map indexed by the physical address of the entry point.
+  // Table indexed by the effective address and MSR bits of the entry point.
   // This is used to query the block based on the current PC in a slow way.
-  std::multimap<u32, JitBlock> block_map;  // start_addr -> block
+  JitBlockTable block_map;  // BlockKey(start_addr, msr) -> block
+
+  // Blocks are allocated in slabs and reused, so that their addresses stay stable.
+  static constexpr size_t BLOCK_SLAB_SIZE = 0x400;
+  std::vector<std::unique_ptr<JitBlock[]>> block_slabs;
+  std::vector<JitBlock*> free_blocks;
 
   // Range of overlapping code indexed by a masked physical address.
   // This is used for invalidation of memory regions. The range is grouped
   // in macro blocks of each 0x100 bytes.
   static constexpr u32 BLOCK_RANGE_MAP_ELEMENTS = 0x100;
-  std::map<u32, std::set<JitBlock*>> block_range_map;
+  std::unordered_map<u32, std::vector<JitBlock*>> block_range_map;
 
   // This bitsets shows which cachelines overlap with any blocks.
   // It is used to provide a fast way to query if no icache invalidation is needed.
@@ -190,4 +316,17 @@ private:
   // This array is indexed with the masked PC and likely holds the correct block id.
   // This is used as a fast cache of block_map used in the assembly dispatcher.
   std::array<JitBlock*, FAST_BLOCK_MAP_ELEMENTS> fast_block_map;  // start_addr & mask -> number
+
+  // All blocks compiled in this and earlier sessions of the running game, which are written
+  // to its warm start profile on shutdown.
+  std::unordered_map<u64, WarmStartEntry> m_warm_start_profile;  // BlockKey -> entry
+
+  std::unordered_map<u32, RetiredProfile> m_retired_profiles;  // start_addr -> profile
+
+  // Blocks of the profile which still have to be compiled, hottest first.
+  std::vector<WarmStartEntry> m_warm_start_queue;
+  size_t m_warm_start_position = 0;
+  u64 m_warm_start_deadline = 0;
+  bool m_warm_start_enabled = false;
+  bool m_warm_start_loaded = false;
 };
@@ -8,7 +8,9 @@
 #include <cinttypes>
 #include <cstdio>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,15 +19,21 @@
 #endif
 
 #include "Common/ChunkFile.h"
+#include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 
+#include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/Profiler.h"
@@ -76,6 +84,7 @@ CPUCoreBase* InitJitCore(PowerPC::CPUCore core)
     return nullptr;
   }
   g_jit->Init();
+  g_jit->jo.profile_blocks = SConfig::GetInstance().bJITProfiling;
   return g_jit;
 }
 
@@ -89,7 +98,15 @@ void SetProfilingState(ProfilingState state)
   if (!g_jit)
     return;
 
-  g_jit->jo.profile_blocks = state == ProfilingState::Enabled;
+  const bool enabled = state == ProfilingState::Enabled;
+  if (g_jit->jo.profile_blocks == enabled)
+    return;
+
+  // The profiling code is part of the compiled blocks, so they have to be compiled again.
+  g_jit->ClearCache();
+  if (enabled)
+    g_jit->GetBlockCache()->ClearRetiredProfiles();
+  g_jit->jo.profile_blocks = enabled;
 }
 
 void WriteProfileResults(const std::string& filename)
@@ -132,23 +149,253 @@ void GetProfileResults(Profiler::ProfileStats* prof_stats)
     Core::SetState(Core::State::Paused);
 
   QueryPerformanceFrequency((LARGE_INTEGER*)&prof_stats->countsPerSec);
-  g_jit->GetBlockCache()->RunOnBlocks([&prof_stats](const JitBlock& block) {
-    const auto& data = block.profile_data;
+
+  // Blocks which were compiled several times are merged by their entry address.
+  std::unordered_map<u32, size_t> stat_index;
+  const auto add_stat = [&prof_stats, &stat_index](u32 address, u32 code_size,
+                                                   const JitBlock::ProfileData& data) {
     u64 cost = data.downcountCounter;
     u64 timecost = data.ticCounter;
-    // Todo: tweak.
-    if (data.runCount >= 1)
-      prof_stats->block_stats.emplace_back(block.effectiveAddress, cost, timecost, data.runCount,
-                                           block.codeSize);
     prof_stats->cost_sum += cost;
     prof_stats->timecost_sum += timecost;
+    // Todo: tweak.
+    if (data.runCount < 1)
+      return;
+
+    const auto it = stat_index.find(address);
+    if (it == stat_index.end())
+    {
+      stat_index.emplace(address, prof_stats->block_stats.size());
+      prof_stats->block_stats.emplace_back(address, cost, timecost, data.runCount, code_size);
+      return;
+    }
+    Profiler::BlockStat& stat = prof_stats->block_stats[it->second];
+    stat.cost += cost;
+    stat.tick_counter += timecost;
+    stat.run_count += data.runCount;
+  };
+  g_jit->GetBlockCache()->RunOnBlocks([&add_stat](const JitBlock& block) {
+    add_stat(block.effectiveAddress, block.codeSize, block.profile_data);
   });
+  g_jit->GetBlockCache()->RunOnRetiredProfiles(add_stat);
 
   sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
   if (old_state == Core::State::Running)
     Core::SetState(Core::State::Running);
 }
 
+// Just enough of the protobuf wire format to write pprof profiles.
+class ProtoWriter
+{
+public:
+  void Varint(u64 value)
+  {
+    while (value >= 0x80)
+    {
+      m_data.push_back(static_cast<u8>(value | 0x80));
+      value >>= 7;
+    }
+    m_data.push_back(static_cast<u8>(value));
+  }
+
+  void UInt(u32 field, u64 value)
+  {
+    Varint(field << 3);
+    Varint(value);
+  }
+
+  void Bytes(u32 field, const void* data, size_t size)
+  {
+    Varint(field << 3 | 2);
+    Varint(size);
+    const u8* bytes = static_cast<const u8*>(data);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+  }
+
+  void String(u32 field, const std::string& str) { Bytes(field, str.data(), str.size()); }
+  void Message(u32 field, const ProtoWriter& msg)
+  {
+    Bytes(field, msg.m_data.data(), msg.m_data.size());
+  }
+
+  void Packed(u32 field, const std::vector<u64>& values)
+  {
+    ProtoWriter packed;
+    for (u64 value : values)
+      packed.Varint(value);
+    Message(field, packed);
+  }
+
+  const std::vector<u8>& GetData() const { return m_data; }
+
+private:
+  std::vector<u8> m_data;
+};
+
+// Returns the symbols the profile is attributed to. Without a symbol map, the guest functions are
+// found by scanning RAM for call targets.
+static PPCSymbolDB* GetProfileSymbols(PPCSymbolDB* scanned_db)
+{
+  if (!g_symbolDB.Symbols().empty())
+    return &g_symbolDB;
+
+  PPCAnalyst::FindFunctions(0x80000000, 0x80000000 + Memory::REALRAM_SIZE, scanned_db);
+  return scanned_db;
+}
+
+static const Common::Symbol* GetProfileFunction(PPCSymbolDB* symbols, u32 address)
+{
+  const Common::Symbol* symbol = symbols->GetSymbolFromAddr(address);
+  if (!symbol || symbol->type != Common::Symbol::Type::Function)
+    return nullptr;
+  return symbol;
+}
+
+static u64 GetProfileNanoseconds(const Profiler::ProfileStats& prof_stats, u64 ticks)
+{
+  return static_cast<u64>(static_cast<double>(ticks) * 1000000000.0 /
+                          static_cast<double>(prof_stats.countsPerSec));
+}
+
+static bool WriteFlamegraph(const std::string& filename, const Profiler::ProfileStats& prof_stats,
+                            PPCSymbolDB* symbols)
+{
+  File::IOFile f(filename, "w");
+  if (!f)
+    return false;
+
+  // One folded stack per block: the guest function, then the block inside of it.
+  for (const auto& stat : prof_stats.block_stats)
+  {
+    const u64 time = GetProfileNanoseconds(prof_stats, stat.tick_counter);
+    if (time == 0)
+      continue;
+
+    const Common::Symbol* function = GetProfileFunction(symbols, stat.addr);
+    std::string name = function ? function->name : "[unknown]";
+    std::replace(name.begin(), name.end(), ';', ':');
+    fprintf(f.GetHandle(), "%s;%08x %" PRIu64 "\n", name.c_str(), stat.addr, time);
+  }
+  return true;
+}
+
+static bool WritePprof(const std::string& filename, const Profiler::ProfileStats& prof_stats,
+                       PPCSymbolDB* symbols)
+{
+  // message Profile: sample_type = 1, sample = 2, location = 4, function = 5, string_table = 6,
+  // default_sample_type = 14
+  ProtoWriter profile;
+  std::vector<std::string> strings = {""};
+  std::unordered_map<std::string, u64> string_index = {{"", 0}};
+  const auto intern = [&strings, &string_index](const std::string& str) {
+    const auto it = string_index.emplace(str, strings.size());
+    if (it.second)
+      strings.push_back(str);
+    return it.first->second;
+  };
+
+  // message ValueType: type = 1, unit = 2
+  for (const auto& type : {std::make_pair("runs", "count"), std::make_pair("cycles", "count"),
+                           std::make_pair("time", "nanoseconds")})
+  {
+    ProtoWriter value_type;
+    value_type.UInt(1, intern(type.first));
+    value_type.UInt(2, intern(type.second));
+    profile.Message(1, value_type);
+  }
+  profile.UInt(14, intern("time"));
+
+  std::unordered_map<u32, u64> function_ids;
+  for (size_t i = 0; i < prof_stats.block_stats.size(); i++)
+  {
+    const auto& stat = prof_stats.block_stats[i];
+    const Common::Symbol* function = GetProfileFunction(symbols, stat.addr);
+    const u32 function_address = function ? function->address : 0;
+
+    // message Function: id = 1, name = 2, system_name = 3, start_line = 5
+    const auto function_id = function_ids.emplace(function_address, function_ids.size() + 1);
+    if (function_id.second)
+    {
+      const u64 name = intern(function ? function->name : "[unknown]");
+      ProtoWriter func;
+      func.UInt(1, function_id.first->second);
+      func.UInt(2, name);
+      func.UInt(3, name);
+      func.UInt(5, function_address);
+      profile.Message(5, func);
+    }
+
+    // message Location: id = 1, address = 3, line = 4; message Line: function_id = 1
+    const u64 location_id = i + 1;
+    ProtoWriter line;
+    line.UInt(1, function_id.first->second);
+    ProtoWriter location;
+    location.UInt(1, location_id);
+    location.UInt(3, stat.addr);
+    location.Message(4, line);
+    profile.Message(4, location);
+
+    // message Sample: location_id = 1, value = 2
+    ProtoWriter sample;
+    sample.Packed(1, {location_id});
+    const u64 time = GetProfileNanoseconds(prof_stats, stat.tick_counter);
+    sample.Packed(2, {stat.run_count, stat.cost, time});
+    profile.Message(2, sample);
+  }
+
+  for (const std::string& str : strings)
+    profile.String(6, str);
+
+  File::IOFile f(filename, "wb");
+  return f && f.WriteBytes(profile.GetData().data(), profile.GetData().size());
+}
+
+void WriteProfileFlamegraph(const std::string& filename)
+{
+  Profiler::ProfileStats prof_stats;
+  GetProfileResults(&prof_stats);
+  PPCSymbolDB scanned_db;
+  if (!WriteFlamegraph(filename, prof_stats, GetProfileSymbols(&scanned_db)))
+    PanicAlert("Failed to open %s", filename.c_str());
+}
+
+void WriteProfilePprof(const std::string& filename)
+{
+  Profiler::ProfileStats prof_stats;
+  GetProfileResults(&prof_stats);
+  PPCSymbolDB scanned_db;
+  if (!WritePprof(filename, prof_stats, GetProfileSymbols(&scanned_db)))
+    PanicAlert("Failed to open %s", filename.c_str());
+}
+
+void WriteProfileDumps()
+{
+  if (!g_jit || !g_jit->jo.profile_blocks)
+    return;
+
+  std::string game_id = SConfig::GetInstance().GetGameID();
+  if (game_id.empty())
+    game_id = "unknown";
+  const std::string path = File::GetUserPath(D_DUMP_IDX) + "Profiles" DIR_SEP + game_id;
+  File::CreateFullPath(path);
+
+  Profiler::ProfileStats prof_stats;
+  GetProfileResults(&prof_stats);
+  PPCSymbolDB scanned_db;
+  PPCSymbolDB* symbols = GetProfileSymbols(&scanned_db);
+
+  WriteProfileResults(path + ".txt");
+  if (!WriteFlamegraph(path + ".folded", prof_stats, symbols) ||
+      !WritePprof(path + ".pb", prof_stats, symbols))
+  {
+    ERROR_LOG(DYNA_REC, "Failed to write JIT profile %s", path.c_str());
+    return;
+  }
+
+  INFO_LOG(DYNA_REC, "Wrote JIT profile of %zu blocks to %s", prof_stats.block_stats.size(),
+           path.c_str());
+}
+
 int GetHostCode(u32* address, const u8** code, u32* code_size)
 {
   if (!g_jit)
@@ -190,6 +437,10 @@ int GetHostCode(u32* address, const u8** code, u32* code_size)
 
 bool HandleFault(uintptr_t access_address, SContext* ctx)
 {
+  // Writes to pages protected by dirty page tracking must not be mistaken for fastmem misses.
+  if (Memory::HandleDirtyPageFault(access_address))
+    return true;
+
   // Prevent nullptr dereference on a crash with no JIT present
   if (!g_jit)
   {
@@ -263,10 +514,20 @@ void CompileExceptionCheck(ExceptionType type)
   }
 }
 
+void TierUpBlock()
+{
+  if (!g_jit)
+    return;
+
+  g_jit->js.tierUpAddresses.insert(PC);
+  g_jit->GetBlockCache()->InvalidateICache(PC, 4, true);
+}
+
 void Shutdown()
 {
   if (g_jit)
   {
+    WriteProfileDumps();
     g_jit->Shutdown();
     delete g_jit;
     g_jit = nullptr;
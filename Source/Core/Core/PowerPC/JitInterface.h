@@ -47,6 +47,12 @@ enum class ProfilingState
 void SetProfilingState(ProfilingState state);
 void WriteProfileResults(const std::string& filename);
 void GetProfileResults(Profiler::ProfileStats* prof_stats);
+// Writes the profile as folded stacks for flamegraph tools, or as a pprof protobuf. Blocks are
+// attributed to the guest functions of the symbol database.
+void WriteProfileFlamegraph(const std::string& filename);
+void WriteProfilePprof(const std::string& filename);
+// Writes the profile in all formats to the dump directory, named after the running game.
+void WriteProfileDumps();
 int GetHostCode(u32* address, const u8** code, u32* code_size);
 
 // Memory Utilities
@@ -66,6 +72,10 @@ void InvalidateICache(u32 address, u32 size, bool forced);
 
 void CompileExceptionCheck(ExceptionType type);
 
+// Recompiles the block at PC with all optimizations. Called by blocks compiled at the quick tier
+// once they are hot.
+void TierUpBlock();
+
 /// used for the page fault unit test, don't use outside of tests!
 void SetJit(JitBase* jit);
 
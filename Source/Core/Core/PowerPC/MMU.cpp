@@ -4,9 +4,11 @@
 
 #include "Core/PowerPC/MMU.h"
 
+#include <array>
 #include <cstddef>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include "Common/BitUtils.h"
 #include "Common/CommonTypes.h"
@@ -164,6 +166,23 @@ static void EFB_Write(u32 data, u32 addr)
 BatTable ibat_table;
 BatTable dbat_table;
 
+// Logical pages which were mapped into the fastmem arena from the page table, bucketed by TLB index
+// so that tlbie only has to unmap the pages it could have invalidated the translation of.
+static std::array<std::vector<u32>, HW_PAGE_INDEX_MASK + 1> s_fastmem_pages;
+
+static void UnmapFastmemPages(std::vector<u32>& pages)
+{
+  for (u32 page : pages)
+    Memory::UnmapLogicalPage(page);
+  pages.clear();
+}
+
+static void UnmapAllFastmemPages()
+{
+  for (std::vector<u32>& pages : s_fastmem_pages)
+    UnmapFastmemPages(pages);
+}
+
 static void GenerateDSIException(u32 effective_address, bool write);
 
 template <XCheckTLBFlag flag, typename T, bool never_translate = false>
@@ -968,6 +987,8 @@ static void GenerateISIException(u32 effective_address)
 
 void SDRUpdated()
 {
+  UnmapAllFastmemPages();
+
   u32 htabmask = SDR1_HTABMASK(PowerPC::ppcState.spr[SPR_SDR]);
   if (!Common::IsValidLowMask(htabmask))
   {
@@ -1066,6 +1087,13 @@ void InvalidateTLBEntry(u32 address)
   TLBEntry& tlbe_i = ppcState.tlb[1][entry_index];
   tlbe_i.tag[0] = TLBEntry::INVALID_TAG;
   tlbe_i.tag[1] = TLBEntry::INVALID_TAG;
+
+  UnmapFastmemPages(s_fastmem_pages[entry_index]);
+}
+
+void SRUpdated()
+{
+  UnmapAllFastmemPages();
 }
 
 // Page Address Translation
@@ -1161,6 +1189,34 @@ static TranslateAddressResult TranslatePageAddress(const u32 address, const XChe
   return TranslateAddressResult{TranslateAddressResult::PAGE_FAULT, 0};
 }
 
+bool HandleFastmemPageFault(u32 address)
+{
+  if (!SConfig::GetInstance().bPageTableFastmem || !MSR.DR)
+    return false;
+
+  // BAT translations are either mapped already or not backed by memory.
+  if (dbat_table[address >> BAT_INDEX_SHIFT] & BAT_MAPPED_BIT)
+    return false;
+
+  // Pages mapped before a memcheck was added are unmapped by MemChecks::Add through DBATUpdated.
+  const u32 page = address & ~(HW_PAGE_SIZE - 1);
+  if (memchecks.OverlapsMemcheck(page, HW_PAGE_SIZE))
+    return false;
+
+  // Fastmem accesses bypass the TLB, so they can't set the referenced and changed bits of the page
+  // table entry. Set both up front as if this was a write; at worst, the OS writes back a page
+  // that wasn't actually changed.
+  const TranslateAddressResult translated = TranslatePageAddress(page, XCheckTLBFlag::Write);
+  if (translated.result != TranslateAddressResult::PAGE_TABLE_TRANSLATED)
+    return false;
+
+  if (!Memory::MapLogicalPage(page, translated.address))
+    return false;
+
+  s_fastmem_pages[(page >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK].push_back(page);
+  return true;
+}
+
 static void UpdateBATs(BatTable& bat_table, u32 base_spr)
 {
   // TODO: Separate BATs for MSR.PR==0 and MSR.PR==1
@@ -1266,6 +1322,9 @@ void DBATUpdated()
   }
 
 #ifndef _ARCH_32
+  // This unmaps the pages from the page table as well.
+  for (std::vector<u32>& pages : s_fastmem_pages)
+    pages.clear();
   Memory::UpdateLogicalMemory(dbat_table);
 #endif
 
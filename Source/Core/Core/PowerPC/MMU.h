@@ -83,10 +83,16 @@ void ClearCacheLine(u32 address);  // Zeroes 32 bytes; address should be 32-byte
 
 // TLB functions
 void SDRUpdated();
+void SRUpdated();
 void InvalidateTLBEntry(u32 address);
 void DBATUpdated();
 void IBATUpdated();
 
+// With bPageTableFastmem, pages translated through the page table are mapped into the logical
+// fastmem view on their first faulting access, and unmapped again by tlbie and changes to SDR1,
+// the segment registers or the BATs. Returns whether the access can simply be retried.
+bool HandleFastmemPageFault(u32 address);
+
 // Result changes based on the BAT registers and MSR.DR.  Returns whether
 // it's safe to optimize a read or write to this address to an unguarded
 // memory access.  Does not consider page tables.
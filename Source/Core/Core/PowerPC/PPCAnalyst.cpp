@@ -205,6 +205,9 @@ static bool CanSwapAdjacentOps(const CodeOp& a, const CodeOp& b)
     return false;
   if (b_flags & (FL_SET_CRx | FL_ENDBLOCK | FL_TIMER | FL_EVIL | FL_SET_OE))
     return false;
+  // loop heads have to stay where the back-edges expect them
+  if (a.isBranchTarget || b.isBranchTarget)
+    return false;
   if ((b_flags & (FL_RC_BIT | FL_RC_BIT_F)) && (b.inst.Rc))
     return false;
   if ((a_flags & (FL_SET_CA | FL_READ_CA)) && (b_flags & (FL_SET_CA | FL_READ_CA)))
@@ -448,6 +451,107 @@ static bool isCror(const CodeOp& a)
   return a.inst.OPCD == 19 && a.inst.SUBOP10 == 449;
 }
 
+// Checks whether a block is a loop which branches back to its start and doesn't do anything but
+// read registers and memory and compare them. Every iteration of such a loop computes the same
+// thing until something outside of the CPU changes memory, which only happens at CoreTiming
+// events, so the JITs can skip ahead to the next event instead of spinning. This catches the usual
+// VI, DSP mailbox and interrupt flag polling loops.
+static bool IsBusyWaitLoop(const CodeBlock& block, const CodeOp* code, u32 instructions)
+{
+  if (instructions == 0)
+    return false;
+
+  const CodeOp& last = code[instructions - 1];
+  if ((last.inst.OPCD != 16 && last.inst.OPCD != 18) || last.inst.LK ||
+      EvaluateBranchTarget(last.inst, last.address) != block.m_address)
+  {
+    return false;
+  }
+
+  // Registers read before being written in the loop must not be written by it, and the CR fields
+  // and carry flag it tests must be set inside of it. Otherwise, the next iteration could differ.
+  BitSet32 gpr_defined, gpr_inputs, gpr_outputs;
+  BitSet8 cr_defined;
+  bool ca_defined = false;
+  for (u32 i = 0; i < instructions; i++)
+  {
+    const CodeOp& op = code[i];
+    const UGeckoInstruction inst = op.inst;
+    const u64 flags = op.opinfo->flags;
+
+    if (flags & (FL_EVIL | FL_CHECKEXCEPTIONS | FL_TIMER | FL_USE_FPU))
+      return false;
+    if ((flags & FL_SET_OE) && inst.OE)
+      return false;
+    if ((flags & FL_READ_CA) && !ca_defined)
+      return false;
+
+    switch (op.opinfo->type)
+    {
+    case OpType::Integer:
+    case OpType::Load:
+      break;
+
+    case OpType::Branch:
+      // Branches which don't end the block are either followed or leave the loop, but none of them
+      // may count down CTR.
+      if (inst.OPCD != 18)
+      {
+        if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+          return false;
+        if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0 && !cr_defined[inst.BI >> 2])
+          return false;
+      }
+      break;
+
+    default:
+      return false;
+    }
+
+    gpr_inputs |= op.regsIn & ~gpr_defined;
+    gpr_defined |= op.regsOut;
+    gpr_outputs |= op.regsOut;
+
+    if ((flags & FL_SET_CR0) || ((flags & FL_RC_BIT) && inst.Rc))
+      cr_defined[0] = true;
+    if (flags & FL_SET_CRn)
+      cr_defined[inst.CRFD] = true;
+    ca_defined |= op.outputCA;
+  }
+
+  return (gpr_inputs & gpr_outputs).Count() == 0;
+}
+
+// Finds conditional branches that jump back into the block, where everything from the target up to
+// the branch is straight-line code, and marks them as loops.
+static void FindLoops(CodeOp* code, u32 instructions)
+{
+  for (u32 i = 0; i < instructions; i++)
+  {
+    CodeOp& op = code[i];
+    const UGeckoInstruction inst = op.inst;
+    if (inst.OPCD != 16 || inst.LK || op.branchIsIdleLoop)
+      continue;
+    if ((inst.BO & BO_DONT_DECREMENT_FLAG) && (inst.BO & BO_DONT_CHECK_CONDITION))
+      continue;
+
+    const u32 target = SignExt16(inst.BD << 2) + (inst.AA ? 0 : op.address);
+    if (target > op.address || (op.address - target) / 4 > i)
+      continue;
+
+    const u32 head = i - (op.address - target) / 4;
+    bool straight = true;
+    for (u32 j = head; j < i && straight; j++)
+      straight = !code[j].skip && code[j + 1].address == code[j].address + 4;
+    if (!straight)
+      continue;
+
+    code[head].isBranchTarget = true;
+    op.branchTo = target;
+    op.branchToIndex = head;
+  }
+}
+
 void PPCAnalyzer::ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse,
                                           ReorderType type)
 {
@@ -711,9 +815,10 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
     //       cache clearning will happen many times.
     if (enable_follow && HasOption(OPTION_BRANCH_FOLLOW) && numFollows < BRANCH_FOLLOWING_THRESHOLD)
     {
-      if (inst.OPCD == 18 && block_size > 1)
+      if (inst.OPCD == 18 && block_size > 1 &&
+          SignExt26(inst.LI << 2) + (inst.AA ? 0 : address) != block->m_address)
       {
-        // Always follow BX instructions.
+        // Always follow BX instructions, unless they loop back to the start of the block.
         follow = true;
         destination = SignExt26(inst.LI << 2) + (inst.AA ? 0 : address);
         if (inst.LK)
@@ -818,6 +923,12 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
 
   block->m_num_instructions = num_inst;
 
+  if (found_exit && block_size > 1 && IsBusyWaitLoop(*block, code, num_inst))
+    code[num_inst - 1].branchIsIdleLoop = true;
+
+  if (HasOption(OPTION_COMPLEX_BLOCK))
+    FindLoops(code, num_inst);
+
   if (block->m_num_instructions > 1)
     ReorderInstructions(block->m_num_instructions, code);
 
@@ -880,6 +991,13 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
     gprBlockInputs |= op.regsIn & ~gprDefined;
     gprDefined |= op.regsOut;
 
+    // A loop head can also be reached from its back-edge, where we know nothing about the FPRs.
+    if (op.isBranchTarget)
+    {
+      fprIsSingle = BitSet32(0);
+      fprIsDuplicated = BitSet32(0);
+      fprIsStoreSafe = BitSet32(0);
+    }
     op.fprIsSingle = fprIsSingle;
     op.fprIsDuplicated = fprIsDuplicated;
     op.fprIsStoreSafe = fprIsStoreSafe;
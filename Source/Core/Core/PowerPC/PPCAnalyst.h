@@ -46,6 +46,9 @@ struct CodeOp  // 16B
   bool canEndBlock;
   bool skipLRStack;
   bool skip;  // followed BL-s for example
+  // Whether this is the branch back to the start of a loop which only polls registers and memory,
+  // so that nothing can change until the next CoreTiming event.
+  bool branchIsIdleLoop;
   // which registers are still needed after this instruction in this block
   BitSet32 fprInUse;
   BitSet32 gprInUse;
@@ -173,9 +176,9 @@ public:
     OPTION_BRANCH_FOLLOW = (1 << 1),
 
     // Complex blocks support jumping backwards on to themselves.
-    // Happens commonly in loops, pretty complex to support.
-    // May require register caches to use register usage metrics.
-    // XXX: NOT COMPLETE
+    // Happens commonly in loops. Conditional branches back into a straight run of the block
+    // mark their target as a loop head (isBranchTarget) and point branchTo/branchToIndex at it.
+    // Requires JIT support: registers must be flushed at loop heads and back-edges.
     OPTION_COMPLEX_BLOCK = (1 << 2),
 
     // Similar to complex blocks.
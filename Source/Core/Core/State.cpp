@@ -4,6 +4,9 @@
 
 #include "Core/State.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <lzo/lzo1x.h>
 #include <map>
 #include <mutex>
@@ -13,11 +16,13 @@
 #include <vector>
 
 #include "Common/ChunkFile.h"
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/Random.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
@@ -29,6 +34,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/GeckoCode.h"
 #include "Core/HW/HW.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
 #include "Core/Movie.h"
@@ -49,12 +55,32 @@ static const u32 IN_LEN = 128 * 1024u;
 
 static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
-static unsigned char __LZO_MMODEL out[OUT_LEN];
-
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+// Each IN_LEN chunk is compressed independently, so chunks are spread over a few worker
+// threads when saving and loading. A chunk's offset in the uncompressed state is always
+// its index times IN_LEN.
+static u32 GetNumCompressionThreads(size_t num_chunks)
+{
+  const size_t threads = std::max(cpu_info.num_cores, 1);
+  return static_cast<u32>(std::max<size_t>(std::min(threads, num_chunks), 1));
+}
 
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+template <typename Func>
+static void ForEachChunkParallel(size_t num_chunks, Func func)
+{
+  const u32 num_threads = GetNumCompressionThreads(num_chunks);
+  std::atomic<size_t> next_chunk{0};
+  const auto worker = [&](u32 thread_index) {
+    for (size_t chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++)
+      func(thread_index, chunk);
+  };
+
+  std::vector<std::thread> threads;
+  for (u32 i = 1; i < num_threads; ++i)
+    threads.emplace_back(worker, i);
+  worker(0);
+  for (std::thread& thread : threads)
+    thread.join();
+}
 
 static std::string g_last_filename;
 
@@ -71,8 +97,17 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 
 static std::thread g_save_thread;
 
+// Bumped whenever the set of things serialized by DoState changes
+static std::atomic<u32> s_layout_generation{0};
+
+// Every saved state gets an ID, so that a state can be recognised when it is loaded again right
+// after it was saved or loaded, which is when memory only needs to be restored partially.
+static bool s_fast_reload = false;
+static u64 s_next_state_id;
+static u64 s_tracked_state_id = 0;
+
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 100;  // Last changed in PR 7728
+static const u32 STATE_VERSION = 101;  // Last changed for the state IDs used by fast reloads
 
 // Maps savestate versions to Dolphin versions.
 // Versions after 42 don't need to be added to this list,
@@ -146,6 +181,13 @@ static bool DoStateVersion(PointerWrap& p, std::string* version_created_by)
 
 void DoState(PointerWrap& p)
 {
+  // Whatever happens below, memory is no longer latched to the tracked state afterwards, unless
+  // this turns out to be a successful save or load.
+  const PointerWrap::Mode mode = p.GetMode();
+  const u64 tracked_state_id = s_tracked_state_id;
+  if (mode == PointerWrap::MODE_READ || mode == PointerWrap::MODE_WRITE)
+    s_tracked_state_id = 0;
+
   std::string version_created_by;
   if (!DoStateVersion(p, &version_created_by))
   {
@@ -166,6 +208,13 @@ void DoState(PointerWrap& p)
     return;
   }
 
+  u64 state_id = s_next_state_id;
+  p.Do(state_id);
+  const bool reload = s_fast_reload && mode == PointerWrap::MODE_READ && tracked_state_id != 0 &&
+                      state_id == tracked_state_id;
+  Memory::SetReloadState(reload);
+  Common::ScopeGuard reload_guard([] { Memory::SetReloadState(false); });
+
   // Begin with video backend, so that it gets a chance to clear its caches and writeback modified
   // things to RAM
   g_video_backend->DoState(p);
@@ -187,6 +236,25 @@ void DoState(PointerWrap& p)
   p.DoMarker("Movie");
   Gecko::DoState(p);
   p.DoMarker("Gecko");
+
+  // Memory has been latched to this state, unless the state was only measured or didn't fit.
+  if (s_fast_reload && p.GetMode() == mode &&
+      (mode == PointerWrap::MODE_READ || mode == PointerWrap::MODE_WRITE))
+  {
+    s_tracked_state_id = state_id;
+    if (mode == PointerWrap::MODE_WRITE)
+      s_next_state_id++;
+  }
+}
+
+void InvalidateLayout()
+{
+  s_layout_generation++;
+}
+
+u32 GetLayoutGeneration()
+{
+  return s_layout_generation.load();
 }
 
 void LoadFromBuffer(std::vector<u8>& buffer)
@@ -202,19 +270,51 @@ void LoadFromBuffer(std::vector<u8>& buffer)
   });
 }
 
-void SaveToBuffer(std::vector<u8>& buffer)
+// Writes the state into the buffer, reusing whatever space it already has. Only if there is
+// none or the state doesn't fit is the state measured, the buffer grown and written again.
+// Returns false if DoState failed.
+static bool DoStateToBuffer(std::vector<u8>& buffer)
 {
-  Core::RunAsCPUThread([&] {
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  buffer.resize(buffer.capacity());
+  while (true)
+  {
+    if (buffer.empty())
+    {
+      u8* ptr = nullptr;
+      PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+      DoState(p);
+      buffer.resize(reinterpret_cast<size_t>(ptr));
+    }
 
+    u8* const start = buffer.data();
+    u8* ptr = start;
+    PointerWrap p(&ptr, buffer.size(), PointerWrap::MODE_WRITE);
     DoState(p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-    buffer.resize(buffer_size);
 
-    ptr = &buffer[0];
-    p.SetMode(PointerWrap::MODE_WRITE);
-    DoState(p);
+    if (p.GetMode() == PointerWrap::MODE_WRITE)
+    {
+      buffer.resize(static_cast<size_t>(ptr - start));
+      return true;
+    }
+    if (!p.Overflowed())
+      return false;
+
+    // The state grew since the buffer was last used, so measure it again.
+    buffer.clear();
+  }
+}
+
+void SaveToBuffer(std::vector<u8>& buffer)
+{
+  Core::RunAsCPUThread([&] { DoStateToBuffer(buffer); });
+}
+
+void EnableFastReload(bool enable)
+{
+  Core::RunAsCPUThread([&] {
+    Memory::EnableDirtyPageTracking(enable);
+    s_fast_reload = enable;
+    s_tracked_state_id = 0;
   });
 }
 
@@ -333,32 +433,35 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 
   if (header.size != 0)  // non-zero header size means the state is compressed
   {
-    lzo_uint i = 0;
-    while (true)
-    {
-      lzo_uint32 cur_len = 0;
-      lzo_uint out_len = 0;
-
-      if ((i + IN_LEN) >= buffer_size)
-      {
-        cur_len = (lzo_uint32)(buffer_size - i);
-      }
-      else
+    const size_t num_chunks = buffer_size / IN_LEN + 1;
+    std::vector<u8> compressed(num_chunks * OUT_LEN);
+    std::vector<lzo_uint> compressed_sizes(num_chunks);
+    std::vector<std::vector<lzo_align_t>> work_memory(GetNumCompressionThreads(num_chunks));
+    for (auto& memory : work_memory)
+      memory.resize((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+
+    std::atomic<bool> failed{false};
+    ForEachChunkParallel(num_chunks, [&](u32 thread_index, size_t chunk) {
+      const size_t offset = chunk * IN_LEN;
+      const lzo_uint cur_len =
+          static_cast<lzo_uint>(std::min<size_t>(IN_LEN, buffer_size - offset));
+      if (lzo1x_1_compress(buffer_data + offset, cur_len, &compressed[chunk * OUT_LEN],
+                           &compressed_sizes[chunk], work_memory[thread_index].data()) != LZO_E_OK)
       {
-        cur_len = IN_LEN;
+        failed = true;
       }
+    });
 
-      if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-        PanicAlertT("Internal LZO Error - compression failed");
+    if (failed)
+      PanicAlertT("Internal LZO Error - compression failed");
 
+    // The last chunk is always shorter than IN_LEN (possibly empty), which marks the end.
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
       // The size of the data to write is 'out_len'
-      f.WriteArray((lzo_uint32*)&out_len, 1);
-      f.WriteBytes(out, out_len);
-
-      if (cur_len != IN_LEN)
-        break;
-
-      i += cur_len;
+      const lzo_uint32 out_len = static_cast<lzo_uint32>(compressed_sizes[chunk]);
+      f.WriteArray(&out_len, 1);
+      f.WriteBytes(&compressed[chunk * OUT_LEN], out_len);
     }
   }
   else  // uncompressed
@@ -373,22 +476,13 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 void SaveAs(const std::string& filename, bool wait)
 {
   Core::RunAsCPUThread([&] {
-    // Measure the size of the buffer.
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-    DoState(p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-    // Then actually do the write.
+    bool saved;
     {
       std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-      g_current_buffer.resize(buffer_size);
-      ptr = &g_current_buffer[0];
-      p.SetMode(PointerWrap::MODE_WRITE);
-      DoState(p);
+      saved = DoStateToBuffer(g_current_buffer);
     }
 
-    if (p.GetMode() == PointerWrap::MODE_WRITE)
+    if (saved)
     {
       Core::DisplayMessage("Saving State...", 1000);
 
@@ -467,27 +561,46 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
     buffer.resize(header.size);
 
-    lzo_uint i = 0;
-    while (true)
+    std::vector<u8> compressed(static_cast<size_t>(f.GetSize() - sizeof(StateHeader)));
+    if (!f.ReadBytes(compressed.data(), compressed.size()))
     {
-      lzo_uint32 cur_len = 0;  // number of bytes to read
-      lzo_uint new_len = 0;    // number of bytes to write
-
-      if (!f.ReadArray(&cur_len, 1))
-        break;
+      PanicAlertT("Internal LZO Error - decompression failed (could not read file)");
+      return;
+    }
 
-      f.ReadBytes(out, cur_len);
-      const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-      if (res != LZO_E_OK)
+    // Collect the chunk boundaries first, then decompress the chunks in parallel.
+    std::vector<std::pair<size_t, lzo_uint32>> chunks;
+    for (size_t offset = 0; offset + sizeof(lzo_uint32) <= compressed.size();)
+    {
+      lzo_uint32 cur_len = 0;  // number of bytes to read
+      std::memcpy(&cur_len, &compressed[offset], sizeof(cur_len));
+      offset += sizeof(cur_len);
+      if (cur_len > compressed.size() - offset || chunks.size() * IN_LEN > buffer.size())
       {
-        // This doesn't seem to happen anymore.
-        PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-                    "Try loading the state again",
-                    res, i, new_len);
+        PanicAlertT("Internal LZO Error - decompression failed (corrupt state file)");
         return;
       }
+      chunks.emplace_back(offset, cur_len);
+      offset += cur_len;
+    }
+
+    std::atomic<int> error{LZO_E_OK};
+    ForEachChunkParallel(chunks.size(), [&](u32, size_t chunk) {
+      const size_t out_offset = chunk * IN_LEN;
+      lzo_uint new_len = std::min<size_t>(IN_LEN, buffer.size() - out_offset);  // bytes to write
+      const int res =
+          lzo1x_decompress_safe(&compressed[chunks[chunk].first], chunks[chunk].second,
+                                buffer.data() + out_offset, &new_len, nullptr);
+      if (res != LZO_E_OK)
+        error = res;
+    });
 
-      i += new_len;
+    if (error != LZO_E_OK)
+    {
+      PanicAlertT("Internal LZO Error - decompression failed (%d)\n"
+                  "Try loading the state again",
+                  error.load());
+      return;
     }
   }
   else  // uncompressed
@@ -582,6 +695,10 @@ void SetOnAfterLoadCallback(AfterLoadCallbackFunc callback)
 
 void Init()
 {
+  InvalidateLayout();
+  s_next_state_id = Common::Random::GenerateValue<u64>() | 1;
+  s_tracked_state_id = 0;
+
   if (lzo_init() != LZO_E_OK)
     PanicAlertT("Internal LZO Error - lzo_init() failed");
 }
@@ -49,9 +49,20 @@ void SaveAs(const std::string& filename, bool wait = false);
 void LoadAs(const std::string& filename);
 
 void DoState(PointerWrap& p);
+
+// Called whenever something changes the shape of the savestate (disc change, EXI/SI device
+// change, ...), so that users who cache a measured state size know to measure it again.
+void InvalidateLayout();
+u32 GetLayoutGeneration();
+
 void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 
+// While enabled, writes to emulated memory are tracked from each state save or load on, so that
+// loading the last saved or loaded state again only restores the memory pages written since.
+// This is what run-ahead does every frame.
+void EnableFastReload(bool enable);
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
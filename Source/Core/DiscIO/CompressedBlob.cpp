@@ -13,10 +13,12 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <zlib.h>
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
@@ -56,6 +58,21 @@ CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string&
   // I still add some safety margin.
   const u32 zlib_buffer_size = m_header.block_size + 64;
   m_zlib_buffer.resize(zlib_buffer_size);
+
+  // Decompress upcoming blocks on other cores when the disc is read sequentially.
+  const int num_workers = std::min(cpu_info.num_cores - 1, 4);
+  if (num_workers > 0)
+  {
+    m_cache.resize(READ_AHEAD_CACHE_BLOCKS);
+    for (CachedBlock& cached_block : m_cache)
+      cached_block.data.resize(m_header.block_size);
+
+    for (int i = 0; i < num_workers; i++)
+    {
+      m_workers.emplace_back(std::make_unique<Common::WorkQueueThread<size_t>>(
+          [this](size_t cache_index) { ReadAheadWorker(cache_index); }));
+    }
+  }
 }
 
 std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile file,
@@ -70,6 +87,8 @@ std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile
 
 CompressedBlobReader::~CompressedBlobReader()
 {
+  // Finish the queued read-ahead before the buffers it writes to go away.
+  m_workers.clear();
 }
 
 // IMPORTANT: Calling this function invalidates all earlier pointers gotten from this function.
@@ -86,6 +105,97 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 }
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
+{
+  if (m_workers.empty())
+    return ReadBlock(block_num, m_zlib_buffer.data(), out_ptr, true);
+
+  const bool sequential = block_num == m_last_block + 1;
+  m_last_block = block_num;
+
+  if (GetCachedBlock(block_num, out_ptr))
+  {
+    QueueReadAhead(block_num + 1);
+    return true;
+  }
+
+  if (sequential)
+    QueueReadAhead(block_num + 1);
+
+  return ReadBlock(block_num, m_zlib_buffer.data(), out_ptr, true);
+}
+
+bool CompressedBlobReader::GetCachedBlock(u64 block_num, u8* out_ptr)
+{
+  std::unique_lock<std::mutex> lk(m_cache_lock);
+  auto it = std::find_if(m_cache.begin(), m_cache.end(), [block_num](const CachedBlock& block) {
+    return block.valid && block.block_num == block_num;
+  });
+  if (it == m_cache.end())
+    return false;
+
+  m_cache_ready.wait(lk, [it] { return it->ready; });
+  if (!it->valid)
+    return false;
+
+  it->last_used = ++m_cache_counter;
+  std::copy(it->data.begin(), it->data.end(), out_ptr);
+  return true;
+}
+
+void CompressedBlobReader::QueueReadAhead(u64 first_block)
+{
+  std::lock_guard<std::mutex> lk(m_cache_lock);
+  const u64 end_block = std::min<u64>(first_block + READ_AHEAD_BLOCKS, m_header.num_blocks);
+  for (u64 block_num = first_block; block_num < end_block; block_num++)
+  {
+    auto it = std::find_if(m_cache.begin(), m_cache.end(), [block_num](const CachedBlock& block) {
+      return block.valid && block.block_num == block_num;
+    });
+    if (it != m_cache.end())
+      continue;
+
+    // Only blocks that aren't being decompressed right now can be replaced.
+    auto victim = m_cache.end();
+    for (auto candidate = m_cache.begin(); candidate != m_cache.end(); ++candidate)
+    {
+      if ((candidate->ready || !candidate->valid) &&
+          (victim == m_cache.end() || candidate->last_used < victim->last_used))
+      {
+        victim = candidate;
+      }
+    }
+    if (victim == m_cache.end())
+      return;
+
+    victim->block_num = block_num;
+    victim->last_used = ++m_cache_counter;
+    victim->valid = true;
+    victim->ready = false;
+
+    m_workers[m_next_worker]->EmplaceItem(static_cast<size_t>(victim - m_cache.begin()));
+    m_next_worker = (m_next_worker + 1) % m_workers.size();
+  }
+}
+
+void CompressedBlobReader::ReadAheadWorker(size_t cache_index)
+{
+  CachedBlock& cached_block = m_cache[cache_index];
+
+  // Nothing but this worker touches a block until it is marked as ready.
+  std::vector<u8> zlib_buffer(m_zlib_buffer.size());
+  const bool success =
+      ReadBlock(cached_block.block_num, zlib_buffer.data(), cached_block.data.data(), false);
+
+  {
+    std::lock_guard<std::mutex> lk(m_cache_lock);
+    cached_block.valid = success;
+    cached_block.ready = true;
+  }
+  m_cache_ready.notify_all();
+}
+
+bool CompressedBlobReader::ReadBlock(u64 block_num, u8* zlib_buffer, u8* out_ptr,
+                                     bool report_errors)
 {
   bool uncompressed = false;
   u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
@@ -94,40 +204,62 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   if (offset & (1ULL << 63))
   {
     if (comp_block_size != m_header.block_size)
+    {
+      if (!report_errors)
+        return false;
       PanicAlert("Uncompressed block with wrong size");
+    }
     uncompressed = true;
     offset &= ~(1ULL << 63);
   }
 
+  if (comp_block_size > m_header.block_size + 64)
+  {
+    if (report_errors)
+      PanicAlert("We have a problem");
+    return false;
+  }
+
   // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
+  memset(&zlib_buffer[comp_block_size], 0, m_header.block_size + 64 - comp_block_size);
 
-  m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
   {
-    PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
-                m_file_name.c_str());
-    m_file.Clear();
-    return false;
+    std::lock_guard<std::mutex> lk(m_file_lock);
+    m_file.Seek(offset, SEEK_SET);
+    if (!m_file.ReadBytes(zlib_buffer, comp_block_size))
+    {
+      m_file.Clear();
+      if (report_errors)
+      {
+        PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                    m_file_name.c_str());
+      }
+      return false;
+    }
   }
 
   // First, check hash.
-  u32 block_hash = Common::HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = Common::HashAdler32(zlib_buffer, comp_block_size);
   if (block_hash != m_hashes[block_num])
+  {
+    // Leave it to the synchronous read to tell the user about it.
+    if (!report_errors)
+      return false;
     PanicAlertT("The disc image \"%s\" is corrupt.\n"
                 "Hash of block %" PRIu64 " is %08x instead of %08x.",
                 m_file_name.c_str(), block_num, block_hash, m_hashes[block_num]);
+  }
 
   if (uncompressed)
   {
-    std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+    std::copy(zlib_buffer, zlib_buffer + comp_block_size, out_ptr);
   }
   else
   {
     z_stream z = {};
-    z.next_in = m_zlib_buffer.data();
+    z.next_in = zlib_buffer;
     z.avail_in = comp_block_size;
-    if (z.avail_in > m_header.block_size)
+    if (z.avail_in > m_header.block_size && report_errors)
     {
       PanicAlert("We have a problem");
     }
@@ -136,22 +268,60 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
     inflateInit(&z);
     int status = inflate(&z, Z_FULL_FLUSH);
     u32 uncomp_size = m_header.block_size - z.avail_out;
+    inflateEnd(&z);
     if (status != Z_STREAM_END)
     {
+      if (!report_errors)
+        return false;
       // this seem to fire wrongly from time to time
       // to be sure, don't use compressed isos :P
       PanicAlert("Failure reading block %" PRIu64 " - out of data and not at end.", block_num);
     }
-    inflateEnd(&z);
     if (uncomp_size != m_header.block_size)
     {
-      PanicAlert("Wrong block size");
+      if (report_errors)
+        PanicAlert("Wrong block size");
       return false;
     }
   }
   return true;
 }
 
+namespace
+{
+struct CompressionBlock
+{
+  std::vector<u8> in_buf;
+  std::vector<u8> out_buf;
+  int comp_size = 0;
+  bool compressed = false;
+  bool success = false;
+};
+}  // namespace
+
+static void CompressBlocks(z_stream* z, CompressionBlock* blocks, size_t count, int block_size)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    CompressionBlock& block = blocks[i];
+
+    int retval = deflateReset(z);
+    z->next_in = block.in_buf.data();
+    z->avail_in = block_size;
+    z->next_out = block.out_buf.data();
+    z->avail_out = block_size;
+
+    block.success = retval == Z_OK;
+    if (!block.success)
+      return;
+
+    int status = deflate(z, Z_FINISH);
+    block.comp_size = block_size - z->avail_out;
+    // Blocks that barely compress are stored as-is.
+    block.compressed = status == Z_STREAM_END && z->avail_out >= 10;
+  }
+}
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type, int block_size, CompressCB callback, void* arg)
 {
@@ -193,9 +363,20 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
+  // Each thread compresses a run of blocks of every batch with its own deflate stream.
+  const size_t num_threads = std::max(cpu_info.num_cores, 1);
+  const size_t blocks_per_thread = 16;
+  std::vector<z_stream> streams(num_threads);
+  for (size_t i = 0; i < num_threads; i++)
+  {
+    streams[i] = {};
+    if (deflateInit(&streams[i], 9) != Z_OK)
+    {
+      for (size_t j = 0; j < i; j++)
+        deflateEnd(&streams[j]);
+      return false;
+    }
+  }
 
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
@@ -210,8 +391,12 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
+  std::vector<CompressionBlock> blocks(num_threads * blocks_per_thread);
+  for (CompressionBlock& block : blocks)
+  {
+    block.in_buf.resize(block_size);
+    block.out_buf.resize(block_size);
+  }
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -227,84 +412,99 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
   bool success = true;
 
-  for (u32 i = 0; i < header.num_blocks; i++)
+  for (u32 batch_start = 0; success && batch_start < header.num_blocks;
+       batch_start += static_cast<u32>(blocks.size()))
   {
-    if (i % progress_monitor == 0)
+    const size_t batch_size = std::min<size_t>(blocks.size(), header.num_blocks - batch_start);
+
+    // The scrubber can only walk the input in order, so reading stays on this thread.
+    for (size_t i = 0; i < batch_size; i++)
     {
-      const u64 inpos = infile.Tell();
-      int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
-
-      std::string temp =
-          StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-                           header.num_blocks, ratio);
-      bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-      if (was_cancelled)
-      {
-        success = false;
-        break;
-      }
+      std::vector<u8>& in_buf = blocks[i].in_buf;
+      size_t read_bytes;
+      if (scrubbing)
+        read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
+      else
+        infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
+      if (read_bytes < header.block_size)
+        std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
     }
 
-    offsets[i] = position;
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t * blocks_per_thread < batch_size; t++)
+    {
+      const size_t first = t * blocks_per_thread;
+      threads.emplace_back(CompressBlocks, &streams[t], &blocks[first],
+                           std::min(blocks_per_thread, batch_size - first), block_size);
+    }
+    CompressBlocks(&streams[0], blocks.data(), std::min(blocks_per_thread, batch_size),
+                   block_size);
+    for (std::thread& thread : threads)
+      thread.join();
 
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
+    for (size_t j = 0; j < batch_size; j++)
+    {
+      const u32 i = batch_start + static_cast<u32>(j);
+      CompressionBlock& block = blocks[j];
 
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
+      if (i % progress_monitor == 0)
+      {
+        const u64 inpos = static_cast<u64>(i) * block_size;
+        int ratio = 0;
+        if (inpos != 0)
+          ratio = (int)(100 * position / inpos);
+
+        std::string temp =
+            StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
+                             header.num_blocks, ratio);
+        bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
+        if (was_cancelled)
+        {
+          success = false;
+          break;
+        }
+      }
 
-    if (retval != Z_OK)
-    {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
-    }
+      if (!block.success)
+      {
+        ERROR_LOG(DISCIO, "Deflate failed");
+        success = false;
+        break;
+      }
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
+      offsets[i] = position;
 
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
-    else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
-    }
+      u8* write_buf;
+      int write_size;
+      if (!block.compressed)
+      {
+        // let's store uncompressed
+        write_buf = block.in_buf.data();
+        offsets[i] |= 0x8000000000000000ULL;
+        write_size = block_size;
+        num_stored++;
+      }
+      else
+      {
+        // let's store compressed
+        write_buf = block.out_buf.data();
+        write_size = block.comp_size;
+        num_compressed++;
+      }
 
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
-    }
+      if (!outfile.WriteBytes(write_buf, write_size))
+      {
+        PanicAlertT("Failed to write the output file \"%s\".\n"
+                    "Check that you have enough space available on the target drive.",
+                    outfile_path.c_str());
+        success = false;
+        break;
+      }
 
-    position += write_size;
+      position += write_size;
 
-    hashes[i] = Common::HashAdler32(write_buf, write_size);
+      hashes[i] = Common::HashAdler32(write_buf, write_size);
+    }
   }
 
   header.compressed_data_size = position;
@@ -325,7 +525,8 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   }
 
   // Cleanup
-  deflateEnd(&z);
+  for (z_stream& z : streams)
+    deflateEnd(&z);
 
   if (success)
   {
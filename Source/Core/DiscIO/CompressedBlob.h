@@ -13,12 +13,15 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/WorkQueueThread.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -55,16 +58,47 @@ public:
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
 private:
+  // A block decompressed ahead of time by the read-ahead workers.
+  struct CachedBlock
+  {
+    std::vector<u8> data;
+    u64 block_num = 0;
+    u64 last_used = 0;
+    bool valid = false;
+    bool ready = false;
+  };
+
   CompressedBlobReader(File::IOFile file, const std::string& filename);
 
+  // Reads, verifies and decompresses a block. zlib_buffer must be at least block_size + 64 bytes.
+  // Errors are only reported to the user when report_errors is set.
+  bool ReadBlock(u64 block_num, u8* zlib_buffer, u8* out_ptr, bool report_errors);
+
+  // Returns true if the block was found in the read-ahead cache and copied to out_ptr.
+  bool GetCachedBlock(u64 block_num, u8* out_ptr);
+  void QueueReadAhead(u64 first_block);
+  void ReadAheadWorker(size_t cache_index);
+
+  static constexpr u32 READ_AHEAD_BLOCKS = 16;
+  static constexpr u32 READ_AHEAD_CACHE_BLOCKS = READ_AHEAD_BLOCKS * 2;
+
   CompressedBlobHeader m_header;
   std::vector<u64> m_block_pointers;
   std::vector<u32> m_hashes;
   int m_data_offset;
   File::IOFile m_file;
+  std::mutex m_file_lock;
   u64 m_file_size;
   std::vector<u8> m_zlib_buffer;
   std::string m_file_name;
+
+  std::vector<CachedBlock> m_cache;
+  std::mutex m_cache_lock;
+  std::condition_variable m_cache_ready;
+  u64 m_cache_counter = 0;
+  u64 m_last_block = ~0ULL;
+  size_t m_next_worker = 0;
+  std::vector<std::unique_ptr<Common::WorkQueueThread<size_t>>> m_workers;
 };
 
 }  // namespace
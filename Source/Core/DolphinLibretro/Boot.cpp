@@ -71,6 +71,12 @@ bool retro_load_game(const struct retro_game_info* game)
   // Fastmem installs custom exception handlers
   // it needs to be disabled when running in a debugger.
   SConfig::GetInstance().bFastmem = Libretro::Options::fastmem;
+  SConfig::GetInstance().bPageTableFastmem = Libretro::Options::pageTableFastmem;
+  SConfig::GetInstance().bJITWarmStart = Libretro::Options::jitWarmStart;
+  SConfig::GetInstance().bJITNativeLoops = Libretro::Options::jitNativeLoops;
+  SConfig::GetInstance().bJITTiering = Libretro::Options::jitTiering;
+  SConfig::GetInstance().bJITInterpretFirst = Libretro::Options::jitInterpretFirst;
+  SConfig::GetInstance().bJITProfiling = Libretro::Options::jitProfiling;
   SConfig::GetInstance().bDSPHLE = Libretro::Options::DSPHLE;
   SConfig::GetInstance().m_DSPEnableJIT = Libretro::Options::DSPEnableJIT;
   SConfig::GetInstance().cpu_core = Libretro::Options::cpu_core;
@@ -108,6 +114,7 @@ bool retro_load_game(const struct retro_game_info* game)
   Config::SetBase(Config::GFX_ENHANCE_FORCE_FILTERING, Libretro::Options::forceTextureFiltering);
   Config::SetBase(Config::GFX_HIRES_TEXTURES, Libretro::Options::loadCustomTextures);
   Config::SetBase(Config::GFX_SAFE_TEXTURE_CACHE_COLOR_SAMPLES, Libretro::Options::textureCacheAccuracy);
+  Config::SetBase(Config::GFX_HACK_TEXTURE_WRITE_TRACKING, Libretro::Options::textureWriteTracking);
 #if 0
   Config::SetBase(Config::GFX_SHADER_COMPILER_THREADS, 1);
   Config::SetBase(Config::GFX_SHADER_PRECOMPILER_THREADS, 1);
@@ -136,6 +143,7 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info* i
 
 void retro_unload_game(void)
 {
+  Libretro::Video::StopGPUThread();
   Core::Stop();
   Core::Shutdown();
   g_video_backend->ShutdownShared();
@@ -1,8 +1,10 @@
 
+#include <algorithm>
 #include <cstdint>
 #include <libretro.h>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "AudioCommon/AudioCommon.h"
 #include "Common/ChunkFile.h"
@@ -19,13 +21,13 @@
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/HW/WiimoteReal/WiimoteReal.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/State.h"
 #include "DolphinLibretro/Input.h"
 #include "DolphinLibretro/Options.h"
 #include "DolphinLibretro/Video.h"
 #include "VideoBackends/OGL/FramebufferManager.h"
 #include "VideoBackends/OGL/Render.h"
-#include "VideoBackends/Software/SWOGLWindow.h"
 #include "VideoCommon/AsyncRequests.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/VideoConfig.h"
@@ -50,32 +52,47 @@ static unsigned int GetSampleRate()
   return 48000;
 }
 
+// Samples are handed to the frontend once per retro_run rather than whenever the emulated
+// DSP pushes a block: the mixer FIFOs already act as a lock-free ring between the CPU thread
+// and the frontend, so all that's left to do here is draining what the frame produced.
 class Stream final : public SoundStream
 {
 public:
   Stream() : SoundStream(GetSampleRate()) {}
   bool SetRunning(bool running) override { return true; }
-  void Update() override
+  void Update() override {}
+
+  void Flush()
   {
-    unsigned int available = m_mixer->AvailableSamples();
-    while (available > MAX_SAMPLES)
-    {
-      m_mixer->Mix(m_buffer, MAX_SAMPLES);
-      batch_cb(m_buffer, MAX_SAMPLES);
-      available -= MAX_SAMPLES;
-    }
-    if (available)
+    const unsigned int available = m_mixer->AvailableSamples();
+    if (!available)
+      return;
+
+    m_buffer.resize(available * 2);
+    m_mixer->Mix(m_buffer.data(), available);
+
+    const s16* samples = m_buffer.data();
+    size_t remaining = available;
+    while (remaining)
     {
-      m_mixer->Mix(m_buffer, available);
-      batch_cb(m_buffer, available);
+      const size_t written = batch_cb(samples, remaining);
+      if (!written)
+        break;
+      samples += written * 2;
+      remaining -= std::min(written, remaining);
     }
   }
 
 private:
-  static constexpr unsigned int MAX_SAMPLES = 512;
-  s16 m_buffer[MAX_SAMPLES * 2];
+  std::vector<s16> m_buffer;
 };
 
+static void Flush()
+{
+  if (g_sound_stream)
+    static_cast<Stream*>(g_sound_stream.get())->Flush();
+}
+
 }  // namespace Audio
 }  // namespace Libretro
 
@@ -127,6 +144,13 @@ void retro_get_system_av_info(retro_system_av_info* info)
   info->geometry.max_width = info->geometry.base_width;
   info->geometry.max_height = info->geometry.base_height;
 
+  // The software renderer presents the XFB itself, which may be larger than the EFB.
+  if (Libretro::Video::hw_render.context_type == RETRO_HW_CONTEXT_NONE)
+  {
+    info->geometry.max_width = std::max(info->geometry.max_width, MAX_XFB_WIDTH);
+    info->geometry.max_height = std::max(info->geometry.max_height, MAX_XFB_HEIGHT);
+  }
+
   if (g_renderer)
     Libretro::widescreen = g_renderer->IsWideScreen() || g_Config.bWidescreenHack;
   else if (SConfig::GetInstance().bWii)
@@ -160,13 +184,7 @@ void retro_run(void)
     g_sound_stream = std::make_unique<Libretro::Audio::Stream>();
     AudioCommon::SetSoundStreamRunning(true);
 
-    if (SConfig::GetInstance().m_strVideoBackend == "Software Renderer")
-    {
-      g_renderer->Shutdown();
-      g_renderer.reset();
-      g_renderer = std::make_unique<SWRenderer>(SWOGLWindow::Create(Libretro::Video::wsi));
-    }
-    else if (SConfig::GetInstance().m_strVideoBackend == "Null")
+    if (SConfig::GetInstance().m_strVideoBackend == "Null")
     {
       g_renderer->Shutdown();
       g_renderer.reset();
@@ -184,8 +202,7 @@ void retro_run(void)
       Common::SleepCurrentThread(100);
   }
 
-  if (SConfig::GetInstance().m_strVideoBackend == "OGL"
-		  || SConfig::GetInstance().m_strVideoBackend == "Software Renderer")
+  if (SConfig::GetInstance().m_strVideoBackend == "OGL")
   {
     OGL::g_ogl_config.defaultFramebuffer =
         (GLuint)Libretro::Video::hw_render.get_current_framebuffer();
@@ -211,6 +228,19 @@ void retro_run(void)
     Libretro::environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &info);
   }
 
+  // Run-ahead loads the state it saved a frame ago every frame, which only needs the memory
+  // written since to be restored.
+  static bool fast_savestates = false;
+  int av_enable = 0;
+  const bool use_fast_savestates =
+      Libretro::environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable) &&
+      (av_enable & 4);
+  if (use_fast_savestates != fast_savestates)
+  {
+    fast_savestates = use_fast_savestates;
+    State::EnableFastReload(fast_savestates);
+  }
+
   if (Libretro::Options::irMode.Updated() || Libretro::Options::irCenter.Updated()
       || Libretro::Options::irWidth.Updated() || Libretro::Options::irHeight.Updated())
   {
@@ -224,31 +254,79 @@ void retro_run(void)
     WiimoteReal::Initialize(Wiimote::InitializeMode::DO_NOT_WAIT_FOR_WIIMOTES);
   }
 
-  Core::DoFrameStep();
-  Fifo::RunGpuLoop();
+  if (Libretro::Options::jitProfiling.Updated())
+  {
+    SConfig::GetInstance().bJITProfiling = Libretro::Options::jitProfiling;
+    Core::RunAsCPUThread([] {
+      if (!SConfig::GetInstance().bJITProfiling)
+        JitInterface::WriteProfileDumps();
+      JitInterface::SetProfilingState(SConfig::GetInstance().bJITProfiling ?
+                                          JitInterface::ProfilingState::Enabled :
+                                          JitInterface::ProfilingState::Disabled);
+    });
+  }
+
+  Libretro::Video::RunFrame();
+  Libretro::Audio::Flush();
 }
 
-size_t retro_serialize_size(void)
+namespace Libretro
 {
-  size_t size = 0;
+namespace Savestate
+{
+// Frontends query the state size every frame when rewind or run-ahead is enabled, so the
+// measured size is cached until something changes the layout of the savestate.
+// The state can still grow slightly between measurements (e.g. scheduled CoreTiming events),
+// so some slack is added on top of the measured size.
+static constexpr size_t SIZE_SLACK = 1024 * 1024;
+
+static size_t cached_size = 0;
+static u32 cached_generation = 0;
+
+static size_t GetSize()
+{
+  const u32 generation = State::GetLayoutGeneration();
+  if (cached_size && cached_generation == generation)
+    return cached_size;
 
+  size_t size = 0;
   Core::RunAsCPUThread([&] {
     PointerWrap p((u8**)&size, PointerWrap::MODE_MEASURE);
     State::DoState(p);
   });
 
-  return size;
+  cached_size = size + SIZE_SLACK;
+  cached_generation = generation;
+  return cached_size;
+}
+}  // namespace Savestate
+}  // namespace Libretro
+
+size_t retro_serialize_size(void)
+{
+  return Libretro::Savestate::GetSize();
 }
 
 bool retro_serialize(void* data, size_t size)
 {
+  // The state is written straight into the frontend's buffer. Should it not fit, the write
+  // stops and the size gets measured again on the next query.
+  u8* ptr = static_cast<u8*>(data);
+  bool fits = false;
   Core::RunAsCPUThread([&] {
-    PointerWrap p((u8**)&data, PointerWrap::MODE_WRITE);
+    PointerWrap p(&ptr, size, PointerWrap::MODE_WRITE);
     State::DoState(p);
+    fits = p.GetMode() == PointerWrap::MODE_WRITE;
   });
 
-  return true;
+  // Also measure again if the state ate into more than half of the slack.
+  const size_t written = ptr - static_cast<u8*>(data);
+  if (!fits || written + Libretro::Savestate::SIZE_SLACK / 2 > Libretro::Savestate::cached_size)
+    Libretro::Savestate::cached_size = 0;
+
+  return fits;
 }
+
 bool retro_unserialize(const void* data, size_t size)
 {
   Core::RunAsCPUThread([&] {
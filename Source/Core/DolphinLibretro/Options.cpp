@@ -181,11 +181,18 @@ Option<float> cpuClockRate("dolphin_cpu_clock_rate", "CPU Clock Rate",
                             {"80%", 0.8},
                             {"90%", 0.9}});
 Option<std::string> renderer("dolphin_renderer", "Renderer", {"Hardware", "Software", "Null"});
+Option<bool> gpuThread("dolphin_gpu_thread", "Threaded GPU (Vulkan only, restart)", false);
 #ifdef ANDROID
 Option<bool> fastmem("dolphin_fastmem", "Fastmem", false);
 #else
 Option<bool> fastmem("dolphin_fastmem", "Fastmem", true);
 #endif
+Option<bool> pageTableFastmem("dolphin_page_table_fastmem", "Fastmem For MMU Page Tables", false);
+Option<bool> jitWarmStart("dolphin_jit_warm_start", "JIT Warm Start", false);
+Option<bool> jitNativeLoops("dolphin_jit_native_loops", "JIT Native Loops", false);
+Option<bool> jitTiering("dolphin_jit_tiering", "JIT Tiered Compilation", false);
+Option<bool> jitInterpretFirst("dolphin_jit_interpret_first", "JIT Interpret Blocks Once", false);
+Option<bool> jitProfiling("dolphin_jit_profiling", "JIT Profiling (dumped when disabled)", false);
 Option<bool> DSPHLE("dolphin_dsp_hle", "DSP HLE", true);
 Option<bool> DSPEnableJIT("dolphin_dsp_jit", "DSP Enable JIT", true);
 Option<PowerPC::CPUCore> cpu_core("dolphin_cpu_core", "CPU Core",
@@ -235,5 +242,7 @@ Option<bool> loadCustomTextures("dolphin_load_custom_textures", "Load Custom Tex
 Option<bool> cheatsEnabled("dolphin_cheats_enabled", "Internal Cheats Enabled", false);
 Option<int> textureCacheAccuracy("dolphin_texture_cache_accuracy", "Texture Cache Accuracy",
                                  {{"Fast", 128}, {"Middle", 512}, {"Safe", 0}});
+Option<bool> textureWriteTracking("dolphin_texture_write_tracking", "Texture Write Tracking",
+                                  false);
 }  // namespace Options
 }  // namespace Libretro
@@ -66,7 +66,14 @@ extern Option<int> efbScale;
 extern Option<LogTypes::LOG_LEVELS> logLevel;
 extern Option<float> cpuClockRate;
 extern Option<std::string> renderer;
+extern Option<bool> gpuThread;
 extern Option<bool> fastmem;
+extern Option<bool> pageTableFastmem;
+extern Option<bool> jitWarmStart;
+extern Option<bool> jitNativeLoops;
+extern Option<bool> jitTiering;
+extern Option<bool> jitInterpretFirst;
+extern Option<bool> jitProfiling;
 extern Option<bool> DSPHLE;
 extern Option<bool> DSPEnableJIT;
 extern Option<PowerPC::CPUCore> cpu_core;
@@ -90,5 +97,6 @@ extern Option<bool> loadCustomTextures;
 extern Option<bool> bluetoothContinuousScan;
 extern Option<bool> cheatsEnabled;
 extern Option<int> textureCacheAccuracy;
+extern Option<bool> textureWriteTracking;
 }  // namespace Options
 }  // namespace Libretro
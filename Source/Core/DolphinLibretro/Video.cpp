@@ -6,6 +6,7 @@
 #include <libretro.h>
 #include <memory>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #ifdef _WIN32
@@ -17,8 +18,11 @@
 #include <libretro_vulkan.h>
 #endif
 
+#include "Common/Event.h"
+#include "Common/Flag.h"
 #include "Common/GL/GLUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/Thread.h"
 #include "Common/Version.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -46,6 +50,69 @@ struct retro_hw_render_callback hw_render;
 
 WindowSystemInfo wsi(WindowSystemType::Libretro, nullptr, nullptr);
 
+// Threaded GPU mode: the FIFO is processed on a dedicated thread rather than the frontend thread.
+// Each retro_run fences on its own frame, so no latency is added and the GPU thread is idle
+// whenever the frontend thread changes the config or the input state. Only the Vulkan context can
+// be used from another thread, the GL and D3D contexts are bound to the frontend thread.
+static bool use_gpu_thread;
+static std::thread gpu_thread;
+static Common::Flag gpu_thread_running;
+static Common::Event frame_start;
+static Common::Event frame_done;
+
+static void GPUThreadFunc()
+{
+  Common::SetCurrentThreadName("Video thread");
+
+  frame_start.Wait();
+  while (gpu_thread_running.IsSet())
+  {
+    // Returns once the frame has been copied to the XFB, see Core::Callback_VideoCopiedToXFB.
+    Fifo::RunGpuLoop();
+    frame_done.Set();
+    frame_start.Wait();
+  }
+}
+
+void RunFrame()
+{
+  if (!use_gpu_thread)
+  {
+    Core::DoFrameStep();
+    Fifo::RunGpuLoop();
+    return;
+  }
+
+#ifndef __APPLE__
+  if (!gpu_thread.joinable())
+  {
+    Vk::SetDeferredPresentation(true);
+    gpu_thread_running.Set();
+    gpu_thread = std::thread(GPUThreadFunc);
+  }
+
+  // Everything retro_run changed up to here is handed to the GPU thread along with the frame,
+  // and the frame is presented before retro_run returns.
+  Core::DoFrameStep();
+  frame_start.Set();
+  frame_done.Wait();
+  Vk::PresentFrame();
+#endif
+}
+
+void StopGPUThread()
+{
+  if (!gpu_thread.joinable())
+    return;
+
+  gpu_thread_running.Clear();
+  frame_start.Set();
+  gpu_thread.join();
+#ifndef __APPLE__
+  Vk::SetDeferredPresentation(false);
+#endif
+}
+
 static void ContextReset(void)
 {
   DEBUG_LOG(VIDEO, "Context reset!\n");
@@ -217,7 +284,16 @@ static bool CreateDevice(retro_vulkan_context* context, VkInstance instance, VkP
 
 void Init()
 {
-  if (Options::renderer == "Hardware" || Options::renderer == "Software")
+  use_gpu_thread = false;
+  if (Options::renderer == "Software")
+  {
+    // The software renderer hands its frames over as CPU framebuffers, no context is needed.
+    hw_render.context_type = RETRO_HW_CONTEXT_NONE;
+    SConfig::GetInstance().m_strVideoBackend = "Software Renderer";
+    return;
+  }
+
+  if (Options::renderer == "Hardware")
   {
     unsigned preferred;
     hw_render.context_reset      = ContextReset;
@@ -235,10 +311,7 @@ void Init()
          if (environ_cb(RETRO_ENVIRONMENT_SET_HW_RENDER, &hw_render))
          {
            environ_cb(RETRO_ENVIRONMENT_SET_HW_SHARED_CONTEXT, nullptr);
-           if (Options::renderer == "Hardware")
-              SConfig::GetInstance().m_strVideoBackend = "OGL";
-           else
-              SConfig::GetInstance().m_strVideoBackend = "Software Renderer";
+           SConfig::GetInstance().m_strVideoBackend = "OGL";
            return;
          }
       } else {
@@ -253,10 +326,7 @@ void Init()
 			if (environ_cb(RETRO_ENVIRONMENT_SET_HW_RENDER, &hw_render))
             {
                environ_cb(RETRO_ENVIRONMENT_SET_HW_SHARED_CONTEXT, nullptr);
-               if (Options::renderer == "Hardware")
-                  SConfig::GetInstance().m_strVideoBackend = "OGL";
-               else
-                  SConfig::GetInstance().m_strVideoBackend = "Software Renderer";
+               SConfig::GetInstance().m_strVideoBackend = "OGL";
                return;
             }
          }
@@ -293,6 +363,8 @@ void Init()
           };
           environ_cb(RETRO_ENVIRONMENT_SET_HW_RENDER_CONTEXT_NEGOTIATION_INTERFACE, (void*)&iface);
 
+          use_gpu_thread = Options::gpuThread;
+
           SConfig::GetInstance().m_strVideoBackend = "Vulkan";
           return;
       }
@@ -24,6 +24,8 @@ namespace Libretro
 namespace Video
 {
 void Init(void);
+void RunFrame();
+void StopGPUThread();
 extern retro_video_refresh_t video_cb;
 extern struct retro_hw_render_callback hw_render;
 extern WindowSystemInfo wsi;
@@ -31,6 +31,8 @@ void SetSurfaceSize(uint32_t width, uint32_t height);
 void SetHWRenderInterface(retro_hw_render_interface* hw_render_interface);
 void Shutdown();
 void WaitForPresentation();
+void SetDeferredPresentation(bool enable);
+void PresentFrame();
 }  // namespace Vk
 #endif
 
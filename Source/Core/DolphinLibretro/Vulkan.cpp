@@ -2,6 +2,7 @@
 // must be first
 #include "VideoBackends/Vulkan/VulkanLoader.h"
 
+#include <algorithm>
 #include <cassert>
 #include <condition_variable>
 #include <cstring>
@@ -10,6 +11,7 @@
 #include <vector>
 
 #include "DolphinLibretro/Video.h"
+#include "DolphinLibretro/VideoVulkan.h"
 #include "VideoCommon/RenderBase.h"
 
 #define LIBRETRO_VK_WARP_LIST()                                                                    \
@@ -87,6 +89,16 @@ struct VkSwapchainKHR_T
 };
 static VkSwapchainKHR_T chain;
 
+// When the GPU runs on its own thread, presented images are handed to the frontend from
+// retro_run instead, as set_image and video_cb may not be called from any other thread.
+// The frontend keeps sampling the image it was last handed until it gets the next one, so
+// that image and the one waiting to be handed over must not be rendered to.
+static bool deferred_present;
+static bool frame_pending;
+static int frontend_index = -1;
+static unsigned frame_width;
+static unsigned frame_height;
+
 static VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(
       const VkInstanceCreateInfo* pCreateInfo,
       const VkAllocationCallbacks* pAllocator,
@@ -208,6 +220,9 @@ vkCreateSwapchainKHR(VkDevice device,
     chain.count++;
     swapchain_mask >>= 1;
   }
+  // Deferred presentation needs a third image to render to while the frontend holds one and
+  // another one waits to be handed over. It is never acquired otherwise.
+  chain.count = std::max(chain.count, 3u);
   assert(chain.count <= VULKAN_MAX_SWAPCHAIN_IMAGES);
 
   for (uint32_t i = 0; i < chain.count; i++)
@@ -301,6 +316,23 @@ static VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(
       uint64_t timeout, VkSemaphore semaphore,
       VkFence fence, uint32_t* pImageIndex)
 {
+  if (deferred_present)
+  {
+    // The frontend's sync index is only meaningful within retro_run, so just cycle through the
+    // images, skipping the ones held by or waiting for the frontend. Reads of earlier frontend
+    // submissions are ordered before our writes by the layout transition out of
+    // SHADER_READ_ONLY (see vkCmdPipelineBarrier), as both use the same queue.
+    std::lock_guard<std::mutex> lock(chain.mutex);
+    uint32_t index = (chain.current_index + 1) % chain.count;
+    while (static_cast<int>(index) == frontend_index ||
+           static_cast<int>(index) == chain.current_index)
+    {
+      index = (index + 1) % chain.count;
+    }
+    *pImageIndex = index;
+    return VK_SUCCESS;
+  }
+
   vulkan->wait_sync_index(vulkan->handle);
   *pImageIndex = vulkan->get_sync_index(vulkan->handle);
 #if 0
@@ -321,6 +353,14 @@ static VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(
 #endif
 
   chain.current_index = pPresentInfo->pImageIndices[0];
+  if (deferred_present)
+  {
+    frame_pending = true;
+    frame_width = g_renderer->GetTargetWidth();
+    frame_height = g_renderer->GetTargetHeight();
+    swapchain->condVar.notify_all();
+    return VK_SUCCESS;
+  }
 #if 0
   vulkan->set_image(vulkan->handle, &swapchain->images[pPresentInfo->pImageIndices[0]].retro_image,
                     pPresentInfo->waitSemaphoreCount, pPresentInfo->pWaitSemaphores,
@@ -346,6 +386,28 @@ void WaitForPresentation()
 #endif
 }
 
+void SetDeferredPresentation(bool enable)
+{
+  std::lock_guard<std::mutex> lock(chain.mutex);
+  deferred_present = enable;
+  frame_pending = false;
+  // Whatever was presented last is what the frontend holds now.
+  frontend_index = chain.current_index;
+}
+
+void PresentFrame()
+{
+  std::lock_guard<std::mutex> lock(chain.mutex);
+  if (!frame_pending)
+    return;
+
+  frame_pending = false;
+  frontend_index = chain.current_index;
+  vulkan->set_image(vulkan->handle, &chain.images[chain.current_index].retro_image, 0, nullptr,
+                    vulkan->queue_index);
+  video_cb(RETRO_HW_FRAME_BUFFER_VALID, frame_width, frame_height, 0);
+}
+
 static VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance,
       const VkAllocationCallbacks* pAllocator)
 {
@@ -376,6 +438,8 @@ static VKAPI_ATTR void VKAPI_CALL vkDestroySwapchainKHR(
   memset(&chain.images, 0x00, sizeof(chain.images));
   chain.count = 0;
   chain.current_index = -1;
+  frame_pending = false;
+  frontend_index = -1;
 }
 
 static VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(
@@ -37,6 +37,20 @@ static inline u32 GetDepthOffset(u16 x, u16 y)
   return (x + y * EFB_WIDTH) * 3 + depth_buffer_start;
 }
 
+// Pixels are stored in 3 bytes and must only ever be accessed as such. Tiles are rasterized
+// concurrently, so a wider access could race with the thread drawing the neighbouring pixel.
+static inline u32 LoadPixel(u32 offset)
+{
+  return efb[offset] | efb[offset + 1] << 8 | efb[offset + 2] << 16;
+}
+
+static inline void StorePixel(u32 offset, u32 value)
+{
+  efb[offset] = static_cast<u8>(value);
+  efb[offset + 1] = static_cast<u8>(value >> 8);
+  efb[offset + 2] = static_cast<u8>(value >> 16);
+}
+
 static void SetPixelAlphaOnly(u32 offset, u8 a)
 {
   switch (bpmem.zcontrol.pixel_format)
@@ -49,10 +63,9 @@ static void SetPixelAlphaOnly(u32 offset, u8 a)
   case PEControl::RGBA6_Z24:
   {
     u32 a32 = a;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xffffffc0;
+    u32 val = LoadPixel(offset) & 0xffffffc0;
     val |= (a32 >> 2) & 0x0000003f;
-    *dst = val;
+    StorePixel(offset, val);
   }
   break;
   default:
@@ -68,31 +81,24 @@ static void SetPixelColorOnly(u32 offset, u8* rgb)
   case PEControl::Z24:
   {
     u32 src = *(u32*)rgb;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   case PEControl::RGBA6_Z24:
   {
     u32 src = *(u32*)rgb;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff00003f;
+    u32 val = LoadPixel(offset) & 0x0000003f;
     val |= (src >> 4) & 0x00000fc0;  // blue
     val |= (src >> 6) & 0x0003f000;  // green
     val |= (src >> 8) & 0x00fc0000;  // red
-    *dst = val;
+    StorePixel(offset, val);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
     u32 src = *(u32*)rgb;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   default:
@@ -108,32 +114,24 @@ static void SetPixelAlphaColor(u32 offset, u8* color)
   case PEControl::Z24:
   {
     u32 src = *(u32*)color;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   case PEControl::RGBA6_Z24:
   {
     u32 src = *(u32*)color;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= (src >> 2) & 0x0000003f;  // alpha
-    val |= (src >> 4) & 0x00000fc0;  // blue
-    val |= (src >> 6) & 0x0003f000;  // green
-    val |= (src >> 8) & 0x00fc0000;  // red
-    *dst = val;
+    u32 val = (src >> 2) & 0x0000003f;  // alpha
+    val |= (src >> 4) & 0x00000fc0;     // blue
+    val |= (src >> 6) & 0x0003f000;     // green
+    val |= (src >> 8) & 0x00fc0000;     // red
+    StorePixel(offset, val);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
     u32 src = *(u32*)color;
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= src >> 8;
-    *dst = val;
+    StorePixel(offset, src >> 8);
   }
   break;
   default:
@@ -143,8 +141,7 @@ static void SetPixelAlphaColor(u32 offset, u8* color)
 
 static u32 GetPixelColor(u32 offset)
 {
-  u32 src;
-  std::memcpy(&src, &efb[offset], sizeof(u32));
+  const u32 src = LoadPixel(offset);
 
   switch (bpmem.zcontrol.pixel_format)
   {
@@ -176,19 +173,13 @@ static void SetPixelDepth(u32 offset, u32 depth)
   case PEControl::RGBA6_Z24:
   case PEControl::Z24:
   {
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= depth & 0x00ffffff;
-    *dst = val;
+    StorePixel(offset, depth);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-    u32* dst = (u32*)&efb[offset];
-    u32 val = *dst & 0xff000000;
-    val |= depth & 0x00ffffff;
-    *dst = val;
+    StorePixel(offset, depth);
   }
   break;
   default:
@@ -206,13 +197,13 @@ static u32 GetPixelDepth(u32 offset)
   case PEControl::RGBA6_Z24:
   case PEControl::Z24:
   {
-    depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+    depth = LoadPixel(offset);
   }
   break;
   case PEControl::RGB565_Z16:
   {
     INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-    depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+    depth = LoadPixel(offset);
   }
   break;
   default:
@@ -696,16 +687,19 @@ void ResetPerfQuery()
   perf_values = {};
 }
 
-void IncPerfCounterQuadCount(PerfQueryType type)
+void AddPerfCounterPixels(PerfCounterPixels& pixels)
 {
   // NOTE: hardware doesn't process individual pixels but quads instead.
   // Current software renderer architecture works on pixels though, so
   // we have this "quad" hack here to only increment the registers on
   // every fourth rendered pixel
-  static u32 quad[PQ_NUM_MEMBERS];
-  if (++quad[type] != 3)
-    return;
-  quad[type] = 0;
-  ++perf_values[type];
+  static PerfCounterPixels quad;
+  for (size_t type = 0; type < pixels.size(); type++)
+  {
+    const u32 total = quad[type] + pixels[type];
+    perf_values[type] += total / 3;
+    quad[type] = total % 3;
+    pixels[type] = 0;
+  }
 }
 }
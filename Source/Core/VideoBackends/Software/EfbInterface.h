@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "Common/CommonTypes.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/VideoCommon.h"
@@ -59,5 +61,9 @@ void EncodeXFB(u8* xfb_in_ram, u32 memory_stride, const EFBRectangle& source_rec
 
 u32 GetPerfQueryResult(PerfQueryType type);
 void ResetPerfQuery();
-void IncPerfCounterQuadCount(PerfQueryType type);
+
+// Number of pixels that reached each performance counter.
+using PerfCounterPixels = std::array<u32, PQ_NUM_MEMBERS>;
+// Adds the pixels to the performance counters and resets them.
+void AddPerfCounterPixels(PerfCounterPixels& pixels);
 }  // namespace EfbInterface
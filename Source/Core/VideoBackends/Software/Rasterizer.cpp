@@ -3,13 +3,23 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
+#include "Common/Thread.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/NativeVertexFormat.h"
 #include "VideoBackends/Software/Rasterizer.h"
 #include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoConfig.h"
@@ -19,22 +29,83 @@ namespace Rasterizer
 {
 static constexpr int BLOCK_SIZE = 2;
 
+// The triangles of a batch are set up once and binned into screen tiles. The tiles are then
+// drawn concurrently, each one by a single thread and in submission order, so the result is the
+// same as drawing the triangles one after another. This works because nothing else a triangle
+// depends on (bpmem, xfmem, texture memory) can change within a batch.
+static constexpr s32 TILE_SIZE = 32;
+static constexpr s32 TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static constexpr s32 TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+static constexpr u32 NUM_TILES = TILES_X * TILES_Y;
+
+// Batches covering less pixels than this aren't worth waking up the workers for.
+static constexpr s32 MIN_PARALLEL_AREA = 64 * 64;
+static constexpr int MAX_THREADS = 16;
+
+struct TriangleSetup
+{
+  Slope ZSlope;
+  Slope WSlope;
+  Slope ColorSlopes[2][4];
+  Slope TexSlopes[8][3];
+
+  s32 vertex0X;
+  s32 vertex0Y;
+  float vertexOffsetX;
+  float vertexOffsetY;
+
+  // Half-edge constants and deltas, 28.4 fixed point
+  s32 C1, C2, C3;
+  s32 DX12, DX23, DX31;
+  s32 DY12, DY23, DY31;
+
+  // Bounding rectangle, already scissored and aligned to BLOCK_SIZE
+  s32 minx, maxx, miny, maxy;
+};
+
+struct DrawContext
+{
+  Tev tev;
+  RasterBlock rasterBlock;
+  u32 rasterizedPixels;
+};
+
+// Kept across triangles for zfreeze
 static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
 
-static s32 vertex0X;
-static s32 vertex0Y;
-static float vertexOffsetX;
-static float vertexOffsetY;
+static std::vector<std::unique_ptr<DrawContext>> contexts;
+
+static std::vector<TriangleSetup> triangles;
+static std::array<std::vector<u32>, NUM_TILES> tileBins;
+static s32 binnedArea;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+static std::vector<std::thread> workers;
+static std::mutex workMutex;
+static std::condition_variable workEvent;
+static std::condition_variable doneEvent;
+static u32 batchNumber;
+static u32 busyWorkers;
+static bool stopWorkers;
+static std::atomic<u32> nextTile;
+
+static void WorkerThread(DrawContext* ctx, u32 seen_batch);
 
 void Init()
 {
-  tev.Init();
+  Shutdown();
+
+  const int num_threads = MathUtil::Clamp(cpu_info.num_cores, 1, MAX_THREADS);
+  for (int i = 0; i < num_threads; i++)
+  {
+    contexts.push_back(std::make_unique<DrawContext>());
+    contexts.back()->tev.Init();
+    contexts.back()->rasterizedPixels = 0;
+  }
+
+  // The GPU thread draws tiles as well
+  stopWorkers = false;
+  for (int i = 1; i < num_threads; i++)
+    workers.emplace_back(WorkerThread, contexts[i].get(), batchNumber);
 
   // Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the
   // first primitive.
@@ -43,6 +114,20 @@ void Init()
   ZSlope.f0 = 1.f;
 }
 
+void Shutdown()
+{
+  {
+    std::lock_guard<std::mutex> lk(workMutex);
+    stopWorkers = true;
+  }
+  workEvent.notify_all();
+
+  for (std::thread& worker : workers)
+    worker.join();
+  workers.clear();
+  contexts.clear();
+}
+
 // Returns approximation of log2(f) in s28.4
 // results are close enough to use for LOD
 static s32 FixedLog2(float f)
@@ -67,32 +152,35 @@ static inline int iround(float x)
 
 void SetTevReg(int reg, int comp, s16 color)
 {
-  tev.SetRegColor(reg, comp, color);
+  for (auto& ctx : contexts)
+    ctx->tev.SetRegColor(reg, comp, color);
 }
 
-static void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static void Draw(DrawContext& ctx, const TriangleSetup& tri, s32 x, s32 y, s32 xi, s32 yi)
 {
-  INCSTAT(stats.thisFrame.rasterizedPixels);
+  Tev& tev = ctx.tev;
+  ctx.rasterizedPixels++;
 
-  float dx = vertexOffsetX + (float)(x - vertex0X);
-  float dy = vertexOffsetY + (float)(y - vertex0Y);
+  float dx = tri.vertexOffsetX + (float)(x - tri.vertex0X);
+  float dy = tri.vertexOffsetY + (float)(y - tri.vertex0Y);
 
-  s32 z = (s32)MathUtil::Clamp<float>(ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
+  s32 z = (s32)MathUtil::Clamp<float>(tri.ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
 
   if (bpmem.UseEarlyDepthTest() && g_ActiveConfig.bZComploc)
   {
     // TODO: Test if perf regs are incremented even if test is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+    tev.PerfPixels[PQ_ZCOMP_INPUT_ZCOMPLOC]++;
     if (bpmem.zmode.testenable)
     {
       // early z
       if (!EfbInterface::ZCompare(x, y, z))
         return;
     }
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
+    tev.PerfPixels[PQ_ZCOMP_OUTPUT_ZCOMPLOC]++;
   }
 
-  RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+  const RasterBlock& rasterBlock = ctx.rasterBlock;
+  const RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
   tev.Position[0] = x;
   tev.Position[1] = y;
@@ -103,7 +191,7 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
   {
     for (int comp = 0; comp < 4; comp++)
     {
-      u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+      u16 color = (u16)tri.ColorSlopes[i][comp].GetValue(dx, dy);
 
       // clamp color value to 0
       u16 mask = ~(color >> 8);
@@ -135,16 +223,16 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
   tev.Draw();
 }
 
-static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
+static void InitTriangle(TriangleSetup* tri, float X1, float Y1, s32 xi, s32 yi)
 {
-  vertex0X = xi;
-  vertex0Y = yi;
+  tri->vertex0X = xi;
+  tri->vertex0Y = yi;
 
   // adjust a little less than 0.5
   const float adjust = 0.495f;
 
-  vertexOffsetX = ((float)xi - X1) + adjust;
-  vertexOffsetY = ((float)yi - Y1) + adjust;
+  tri->vertexOffsetX = ((float)xi - X1) + adjust;
+  tri->vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 static void InitSlope(Slope* slope, float f1, float f2, float f3, float DX31, float DX12,
@@ -160,7 +248,8 @@ static void InitSlope(Slope* slope, float f1, float f2, float f3, float DX31, fl
   slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32* lodp, bool* linear,
+                                u32 texmap, u32 texcoord)
 {
   const FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
   const u8 subTexmap = texmap & 3;
@@ -173,17 +262,17 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
   float sDelta, tDelta;
   if (tm0.diag_lod)
   {
-    float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-    float* uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+    const float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+    const float* uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
     sDelta = fabsf(uv0[0] - uv1[0]);
     tDelta = fabsf(uv0[1] - uv1[1]);
   }
   else
   {
-    float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-    float* uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-    float* uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+    const float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+    const float* uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+    const float* uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
     sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
     tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -208,7 +297,7 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
   *lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(RasterBlock& rasterBlock, const TriangleSetup& tri, s32 blockX, s32 blockY)
 {
   for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
   {
@@ -216,10 +305,10 @@ static void BuildBlock(s32 blockX, s32 blockY)
     {
       RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-      float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-      float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+      float dx = tri.vertexOffsetX + (float)(xi + blockX - tri.vertex0X);
+      float dy = tri.vertexOffsetY + (float)(yi + blockY - tri.vertex0Y);
 
-      float invW = 1.0f / WSlope.GetValue(dx, dy);
+      float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
       pixel.InvW = invW;
 
       // tex coords
@@ -228,13 +317,13 @@ static void BuildBlock(s32 blockX, s32 blockY)
         float projection = invW;
         if (xfmem.texMtxInfo[i].projection)
         {
-          float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
+          float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
           if (q != 0.0f)
             projection = invW / q;
         }
 
-        pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-        pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+        pixel.Uv[i][0] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+        pixel.Uv[i][1] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
       }
     }
   }
@@ -247,7 +336,8 @@ static void BuildBlock(s32 blockX, s32 blockY)
     u32 texcoord = indref & 3;
     indref >>= 3;
 
-    CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+    CalculateLOD(rasterBlock, &rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap,
+                 texcoord);
   }
 
   for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -259,11 +349,211 @@ static void BuildBlock(s32 blockX, s32 blockY)
       u32 texmap = order.getTexMap(stageOdd);
       u32 texcoord = order.getTexCoord(stageOdd);
 
-      CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+      CalculateLOD(rasterBlock, &rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap,
+                   texcoord);
     }
   }
 }
 
+static void DrawTriangle(DrawContext& ctx, const TriangleSetup& tri, s32 minx, s32 maxx, s32 miny,
+                         s32 maxy)
+{
+  const s32 C1 = tri.C1;
+  const s32 C2 = tri.C2;
+  const s32 C3 = tri.C3;
+  const s32 DX12 = tri.DX12;
+  const s32 DX23 = tri.DX23;
+  const s32 DX31 = tri.DX31;
+  const s32 DY12 = tri.DY12;
+  const s32 DY23 = tri.DY23;
+  const s32 DY31 = tri.DY31;
+
+  // Fixed-pos32 deltas
+  const s32 FDX12 = DX12 * 16;
+  const s32 FDX23 = DX23 * 16;
+  const s32 FDX31 = DX31 * 16;
+
+  const s32 FDY12 = DY12 * 16;
+  const s32 FDY23 = DY23 * 16;
+  const s32 FDY31 = DY31 * 16;
+
+  // Loop through blocks
+  for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+  {
+    for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+    {
+      // Corners of block
+      s32 x0 = x << 4;
+      s32 x1 = (x + BLOCK_SIZE - 1) << 4;
+      s32 y0 = y << 4;
+      s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+
+      // Evaluate half-space functions
+      bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
+      bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
+      bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
+      bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
+      int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+      bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
+      bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
+      bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
+      bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
+      int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+      bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
+      bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
+      bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
+      bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
+      int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+
+      // Skip block when outside an edge
+      if (a == 0x0 || b == 0x0 || c == 0x0)
+        continue;
+
+      BuildBlock(ctx.rasterBlock, tri, x, y);
+
+      // Accept whole block when totally covered
+      if (a == 0xF && b == 0xF && c == 0xF)
+      {
+        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+        {
+          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+          {
+            Draw(ctx, tri, x + ix, y + iy, ix, iy);
+          }
+        }
+      }
+      else  // Partially covered block
+      {
+        s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
+        s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
+        s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+
+        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+        {
+          s32 CX1 = CY1;
+          s32 CX2 = CY2;
+          s32 CX3 = CY3;
+
+          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+          {
+            if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+            {
+              Draw(ctx, tri, x + ix, y + iy, ix, iy);
+            }
+
+            CX1 -= FDY12;
+            CX2 -= FDY23;
+            CX3 -= FDY31;
+          }
+
+          CY1 += FDX12;
+          CY2 += FDX23;
+          CY3 += FDX31;
+        }
+      }
+    }
+  }
+}
+
+static void DrawTiles(DrawContext& ctx)
+{
+  for (u32 tile = nextTile++; tile < NUM_TILES; tile = nextTile++)
+  {
+    const s32 left = static_cast<s32>(tile % TILES_X) * TILE_SIZE;
+    const s32 top = static_cast<s32>(tile / TILES_X) * TILE_SIZE;
+
+    for (u32 index : tileBins[tile])
+    {
+      const TriangleSetup& tri = triangles[index];
+      DrawTriangle(ctx, tri, std::max(tri.minx, left), std::min(tri.maxx, left + TILE_SIZE),
+                   std::max(tri.miny, top), std::min(tri.maxy, top + TILE_SIZE));
+    }
+  }
+}
+
+static void WorkerThread(DrawContext* ctx, u32 seen_batch)
+{
+  Common::SetCurrentThreadName("Software rasterizer");
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lk(workMutex);
+      workEvent.wait(lk, [&] { return stopWorkers || batchNumber != seen_batch; });
+      if (stopWorkers)
+        return;
+      seen_batch = batchNumber;
+    }
+
+    DrawTiles(*ctx);
+
+    {
+      std::lock_guard<std::mutex> lk(workMutex);
+      if (--busyWorkers == 0)
+        doneEvent.notify_one();
+    }
+  }
+}
+
+static void BinTriangle(const TriangleSetup& tri)
+{
+  const u32 index = static_cast<u32>(triangles.size());
+  triangles.push_back(tri);
+  binnedArea += (tri.maxx - tri.minx) * (tri.maxy - tri.miny);
+
+  const s32 tile_right = (tri.maxx + TILE_SIZE - 1) / TILE_SIZE;
+  const s32 tile_bottom = (tri.maxy + TILE_SIZE - 1) / TILE_SIZE;
+  for (s32 ty = tri.miny / TILE_SIZE; ty < tile_bottom; ty++)
+  {
+    for (s32 tx = tri.minx / TILE_SIZE; tx < tile_right; tx++)
+      tileBins[ty * TILES_X + tx].push_back(index);
+  }
+}
+
+void Flush()
+{
+  if (!triangles.empty())
+  {
+    nextTile = 0;
+    if (binnedArea >= MIN_PARALLEL_AREA)
+    {
+      {
+        std::lock_guard<std::mutex> lk(workMutex);
+        busyWorkers = static_cast<u32>(workers.size());
+        batchNumber++;
+      }
+      workEvent.notify_all();
+
+      DrawTiles(*contexts[0]);
+
+      std::unique_lock<std::mutex> lk(workMutex);
+      doneEvent.wait(lk, [] { return busyWorkers == 0; });
+    }
+    else
+    {
+      DrawTiles(*contexts[0]);
+    }
+
+    triangles.clear();
+    for (auto& bin : tileBins)
+      bin.clear();
+    binnedArea = 0;
+  }
+
+  for (auto& ctx : contexts)
+  {
+    ADDSTAT(stats.thisFrame.rasterizedPixels, ctx->rasterizedPixels);
+    ADDSTAT(stats.thisFrame.tevPixelsIn, ctx->tev.PixelsIn);
+    ADDSTAT(stats.thisFrame.tevPixelsOut, ctx->tev.PixelsOut);
+    EfbInterface::AddPerfCounterPixels(ctx->tev.PerfPixels);
+    ctx->rasterizedPixels = 0;
+    ctx->tev.PixelsIn = 0;
+    ctx->tev.PixelsOut = 0;
+  }
+}
+
 void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
                            const OutputVertexData* v2)
 {
@@ -290,15 +580,6 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   const s32 DY23 = Y2 - Y3;
   const s32 DY31 = Y3 - Y1;
 
-  // Fixed-pos32 deltas
-  const s32 FDX12 = DX12 * 16;
-  const s32 FDX23 = DX23 * 16;
-  const s32 FDX31 = DX31 * 16;
-
-  const s32 FDY12 = DY12 * 16;
-  const s32 FDY23 = DY23 * 16;
-  const s32 FDY31 = DY31 * 16;
-
   // Bounding rectangle
   s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
   s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
@@ -333,6 +614,8 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (minx >= maxx || miny >= maxy)
     return;
 
+  TriangleSetup tri;
+
   // Setup slopes
   float fltx1 = v0->screenPosition.x;
   float flty1 = v0->screenPosition.y;
@@ -341,11 +624,11 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   float fltdy12 = flty1 - v1->screenPosition.y;
   float fltdy31 = v2->screenPosition.y - flty1;
 
-  InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
+  InitTriangle(&tri, fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
 
   float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w,
                 1.0f / v2->projectedPosition.w};
-  InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+  InitSlope(&tri.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 
   // TODO: The zfreeze emulation is not quite correct, yet!
   // Many things might prevent us from reaching this line (culling, clipping, scissoring).
@@ -356,19 +639,21 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (!bpmem.genMode.zfreeze || !g_ActiveConfig.bZFreeze)
     InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31,
               fltdx12, fltdy12, fltdy31);
+  tri.ZSlope = ZSlope;
 
   for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
   {
     for (int comp = 0; comp < 4; comp++)
-      InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp],
-                fltdx31, fltdx12, fltdy12, fltdy31);
+      InitSlope(&tri.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp],
+                v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
   }
 
   for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
   {
     for (int comp = 0; comp < 3; comp++)
-      InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1],
-                v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+      InitSlope(&tri.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0],
+                v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12,
+                fltdy12, fltdy31);
   }
 
   // Half-edge constants
@@ -384,87 +669,28 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (DY31 < 0 || (DY31 == 0 && DX31 > 0))
     C3++;
 
-  // Start in corner of 8x8 block
-  minx &= ~(BLOCK_SIZE - 1);
-  miny &= ~(BLOCK_SIZE - 1);
-
-  // Loop through blocks
-  for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
-  {
-    for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
-    {
-      // Corners of block
-      s32 x0 = x << 4;
-      s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-      s32 y0 = y << 4;
-      s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-      // Evaluate half-space functions
-      bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-      bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-      bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-      bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-      int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
-
-      bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-      bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-      bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-      bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-      int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
-
-      bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-      bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-      bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-      bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-      int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
-
-      // Skip block when outside an edge
-      if (a == 0x0 || b == 0x0 || c == 0x0)
-        continue;
-
-      BuildBlock(x, y);
+  tri.C1 = C1;
+  tri.C2 = C2;
+  tri.C3 = C3;
+  tri.DX12 = DX12;
+  tri.DX23 = DX23;
+  tri.DX31 = DX31;
+  tri.DY12 = DY12;
+  tri.DY23 = DY23;
+  tri.DY31 = DY31;
 
-      // Accept whole block when totally covered
-      if (a == 0xF && b == 0xF && c == 0xF)
-      {
-        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-        {
-          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-          {
-            Draw(x + ix, y + iy, ix, iy);
-          }
-        }
-      }
-      else  // Partially covered block
-      {
-        s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-        s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-        s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
-
-        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-        {
-          s32 CX1 = CY1;
-          s32 CX2 = CY2;
-          s32 CX3 = CY3;
-
-          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-          {
-            if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-            {
-              Draw(x + ix, y + iy, ix, iy);
-            }
-
-            CX1 -= FDY12;
-            CX2 -= FDY23;
-            CX3 -= FDY31;
-          }
-
-          CY1 += FDX12;
-          CY2 += FDX23;
-          CY3 += FDX31;
-        }
-      }
-    }
-  }
+  // Start in corner of 8x8 block
+  tri.minx = minx & ~(BLOCK_SIZE - 1);
+  tri.miny = miny & ~(BLOCK_SIZE - 1);
+  tri.maxx = maxx;
+  tri.maxy = maxy;
+
+  // The bounding box and the TEV debug dumps are shared between all pixels, draw those directly.
+  const bool draw_directly = workers.empty() || BoundingBox::active ||
+                             g_ActiveConfig.bDumpTevStages || g_ActiveConfig.bDumpTevTextureFetches;
+  if (draw_directly)
+    DrawTriangle(*contexts[0], tri, tri.minx, tri.maxx, tri.miny, tri.maxy);
+  else
+    BinTriangle(tri);
 }
 }
@@ -11,6 +11,10 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 void Init();
+void Shutdown();
+
+// Draws all triangles of the current batch. Must be called before anything else accesses the EFB.
+void Flush();
 
 void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
                            const OutputVertexData* v2);
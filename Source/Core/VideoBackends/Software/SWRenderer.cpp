@@ -8,6 +8,8 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/GL/GLContext.h"
+#include "Common/Intrinsics.h"
+#include "Common/MathUtil.h"
 
 #include "Core/Config/GraphicsSettings.h"
 #include "Core/HW/Memmap.h"
@@ -23,6 +25,8 @@
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoConfig.h"
 
+#include "DolphinLibretro/Video.h"
+
 SWRenderer::SWRenderer(std::unique_ptr<SWOGLWindow> window)
     : ::Renderer(static_cast<int>(MAX_XFB_WIDTH), static_cast<int>(MAX_XFB_HEIGHT),
                  AbstractTextureFormat::RGBA8),
@@ -32,7 +36,7 @@ SWRenderer::SWRenderer(std::unique_ptr<SWOGLWindow> window)
 
 bool SWRenderer::IsHeadless() const
 {
-  return m_window->IsHeadless();
+  return m_window && m_window->IsHeadless();
 }
 
 std::unique_ptr<AbstractTexture> SWRenderer::CreateTexture(const TextureConfig& config)
@@ -88,10 +92,59 @@ std::unique_ptr<AbstractPipeline> SWRenderer::CreatePipeline(const AbstractPipel
   return std::make_unique<SWPipeline>();
 }
 
+// Converts the RGBA8 pixels of a SWTexture to the XRGB8888 layout libretro expects.
+static void ConvertToXRGB8888(u32* dst, const u32* src, size_t count)
+{
+  size_t i = 0;
+#ifdef _M_X86
+  const __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+  const __m128i g_mask = _mm_set1_epi32(0x0000FF00);
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i rb = _mm_and_si128(pixels, rb_mask);
+    const __m128i br = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+    const __m128i xrgb = _mm_or_si128(br, _mm_and_si128(pixels, g_mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), xrgb);
+  }
+#endif
+  for (; i < count; i++)
+  {
+    const u32 rb = src[i] & 0x00FF00FF;
+    dst[i] = (rb << 16) | (rb >> 16) | (src[i] & 0x0000FF00);
+  }
+}
+
+// Hands the XFB to the frontend as a CPU framebuffer, no GL context is involved.
+void SWRenderer::PresentFrame(const SW::SWTexture* texture, const EFBRectangle& xfb_region)
+{
+  const TextureConfig& config = texture->GetConfig();
+  const int left = MathUtil::Clamp(xfb_region.left, 0, static_cast<int>(config.width));
+  const int right = MathUtil::Clamp(xfb_region.right, left, static_cast<int>(config.width));
+  const int top = MathUtil::Clamp(xfb_region.top, 0, static_cast<int>(config.height));
+  const int bottom = MathUtil::Clamp(xfb_region.bottom, top, static_cast<int>(config.height));
+  const u32 width = static_cast<u32>(right - left);
+  const u32 height = static_cast<u32>(bottom - top);
+  if (width == 0 || height == 0)
+    return;
+
+  m_frame_buffer.resize(width * height);
+  const u32* src = reinterpret_cast<const u32*>(texture->GetData());
+  for (u32 y = 0; y < height; y++)
+  {
+    ConvertToXRGB8888(&m_frame_buffer[y * width], &src[(top + y) * config.width + left],
+                      width);
+  }
+
+  Libretro::Video::video_cb(m_frame_buffer.data(), width, height, width * sizeof(u32));
+}
+
 // Called on the GPU thread
 void SWRenderer::SwapImpl(AbstractTexture* texture, const EFBRectangle& xfb_region, u64 ticks)
 {
-  if (!IsHeadless())
+  if (!m_window)
+    PresentFrame(static_cast<SW::SWTexture*>(texture), xfb_region);
+  else if (!IsHeadless())
     m_window->ShowImage(texture, xfb_region);
 
   UpdateActiveConfig();
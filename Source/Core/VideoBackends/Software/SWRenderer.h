@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 
@@ -12,6 +13,11 @@
 
 class SWOGLWindow;
 
+namespace SW
+{
+class SWTexture;
+}
+
 class SWRenderer : public Renderer
 {
 public:
@@ -47,5 +53,9 @@ public:
   void ReinterpretPixelData(unsigned int convtype) override {}
 
 private:
+  void PresentFrame(const SW::SWTexture* texture, const EFBRectangle& xfb_region);
+
+  // Without a window, frames are converted to XRGB8888 here and passed to the frontend.
   std::unique_ptr<SWOGLWindow> m_window;
+  std::vector<u32> m_frame_buffer;
 };
@@ -132,6 +132,8 @@ void SWVertexLoader::DrawCurrentBatch(u32 base_index, u32 num_indices, u32 base_
     INCSTAT(stats.thisFrame.numVerticesLoaded)
   }
 
+  Rasterizer::Flush();
+
   DebugUtil::OnObjectEnd();
 }
 
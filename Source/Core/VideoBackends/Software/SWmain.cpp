@@ -80,9 +80,14 @@ bool VideoSoftware::Initialize(const WindowSystemInfo& wsi)
 {
   InitializeShared();
 
-  std::unique_ptr<SWOGLWindow> window = SWOGLWindow::Create(wsi);
-  if (!window)
-    return false;
+  // libretro takes the frames as CPU framebuffers, so no GL window is needed there.
+  std::unique_ptr<SWOGLWindow> window;
+  if (wsi.type != WindowSystemType::Libretro)
+  {
+    window = SWOGLWindow::Create(wsi);
+    if (!window)
+      return false;
+  }
 
   Clipper::Init();
   Rasterizer::Init();
@@ -104,6 +109,7 @@ void VideoSoftware::Shutdown()
   if (g_renderer)
     g_renderer->Shutdown();
 
+  Rasterizer::Shutdown();
   DebugUtil::Shutdown();
   g_framebuffer_manager.reset();
   g_texture_cache.reset();
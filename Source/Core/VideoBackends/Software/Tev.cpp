@@ -27,6 +27,10 @@
 
 void Tev::Init()
 {
+  PixelsIn = 0;
+  PixelsOut = 0;
+  PerfPixels = {};
+
   FixedConstants[0] = 0;
   FixedConstants[1] = 32;
   FixedConstants[2] = 64;
@@ -568,7 +572,7 @@ void Tev::Draw()
   ASSERT(Position[0] >= 0 && Position[0] < EFB_WIDTH);
   ASSERT(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-  INCSTAT(stats.thisFrame.tevPixelsIn);
+  PixelsIn++;
 
   // initial color values
   for (int i = 0; i < 4; i++)
@@ -831,12 +835,12 @@ void Tev::Draw()
   if (late_ztest && bpmem.zmode.testenable)
   {
     // TODO: Check against hw if these values get incremented even if depth testing is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+    PerfPixels[PQ_ZCOMP_INPUT]++;
 
     if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
       return;
 
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+    PerfPixels[PQ_ZCOMP_OUTPUT]++;
   }
 
   // branchless bounding box update
@@ -869,8 +873,8 @@ void Tev::Draw()
   }
 #endif
 
-  INCSTAT(stats.thisFrame.tevPixelsOut);
-  EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+  PixelsOut++;
+  PerfPixels[PQ_BLEND_INPUT]++;
 
   EfbInterface::BlendTev(Position[0], Position[1], output);
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
 #include "VideoCommon/BPMemory.h"
 
 class Tev
@@ -75,6 +77,12 @@ public:
   s32 TextureLod[16];
   bool TextureLinear[16];
 
+  // Counted per instance so that several Tev instances can draw at the same time.
+  // The rasterizer adds them to the global counters after each batch.
+  u32 PixelsIn;
+  u32 PixelsOut;
+  EfbInterface::PerfCounterPixels PerfPixels;
+
   enum
   {
     ALP_C,
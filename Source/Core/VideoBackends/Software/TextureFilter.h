@@ -0,0 +1,105 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+
+namespace TextureSampler
+{
+inline void SetTexel(const u8* inTexel, u32* outTexel, u32 fract)
+{
+  outTexel[0] = inTexel[0] * fract;
+  outTexel[1] = inTexel[1] * fract;
+  outTexel[2] = inTexel[2] * fract;
+  outTexel[3] = inTexel[3] * fract;
+}
+
+inline void AddTexel(const u8* inTexel, u32* outTexel, u32 fract)
+{
+  outTexel[0] += inTexel[0] * fract;
+  outTexel[1] += inTexel[1] * fract;
+  outTexel[2] += inTexel[2] * fract;
+  outTexel[3] += inTexel[3] * fract;
+}
+
+// Weights two texels and stores the sum shifted right by shift.
+inline void BlendTexelsScalar(const u8* texel0, u32 fract0, const u8* texel1, u32 fract1,
+                                     int shift, u8* outTexel)
+{
+  u32 texel[4];
+  SetTexel(texel0, texel, fract0);
+  AddTexel(texel1, texel, fract1);
+  for (int i = 0; i < 4; i++)
+    outTexel[i] = (u8)(texel[i] >> shift);
+}
+
+// Bilinear filter between four texels, fractS and fractT are in 0.7 fixed point.
+inline void BlendTexelsScalar(const u8 (&texels)[4][4], int fractS, int fractT,
+                                     u8* outTexel)
+{
+  const u32 weights[4] = {static_cast<u32>((128 - fractS) * (128 - fractT)),
+                          static_cast<u32>(fractS * (128 - fractT)),
+                          static_cast<u32>((128 - fractS) * fractT),
+                          static_cast<u32>(fractS * fractT)};
+  u32 texel[4];
+  SetTexel(texels[0], texel, weights[0]);
+  for (int i = 1; i < 4; i++)
+    AddTexel(texels[i], texel, weights[i]);
+  for (int i = 0; i < 4; i++)
+    outTexel[i] = (u8)(texel[i] >> 14);
+}
+
+#ifdef _M_X86
+// Returns texel0 * fract0 + texel1 * fract1 for all four channels. The fractions must fit in s16.
+inline __m128i WeightTexels(const u8* texel0, u32 fract0, const u8* texel1, u32 fract1)
+{
+  u32 packed0, packed1;
+  std::memcpy(&packed0, texel0, sizeof(u32));
+  std::memcpy(&packed1, texel1, sizeof(u32));
+
+  // Interleave the channels of both texels, so that pmaddwd can weight and add them in one go
+  const __m128i interleaved = _mm_unpacklo_epi8(
+      _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed0), _mm_cvtsi32_si128(packed1)),
+      _mm_setzero_si128());
+  return _mm_madd_epi16(interleaved, _mm_set1_epi32(static_cast<s32>(fract0 | fract1 << 16)));
+}
+
+inline void StoreTexel(__m128i texel, int shift, u8* outTexel)
+{
+  texel = _mm_srli_epi32(texel, shift);
+  texel = _mm_packus_epi16(_mm_packs_epi32(texel, texel), texel);
+  const u32 packed = static_cast<u32>(_mm_cvtsi128_si32(texel));
+  std::memcpy(outTexel, &packed, sizeof(u32));
+}
+#endif
+
+inline void BlendTexels(const u8* texel0, u32 fract0, const u8* texel1, u32 fract1,
+                               int shift, u8* outTexel)
+{
+#ifdef _M_X86
+  StoreTexel(WeightTexels(texel0, fract0, texel1, fract1), shift, outTexel);
+#else
+  BlendTexelsScalar(texel0, fract0, texel1, fract1, shift, outTexel);
+#endif
+}
+
+inline void BlendTexels(const u8 (&texels)[4][4], int fractS, int fractT, u8* outTexel)
+{
+#ifdef _M_X86
+  const u32 weights[4] = {static_cast<u32>((128 - fractS) * (128 - fractT)),
+                          static_cast<u32>(fractS * (128 - fractT)),
+                          static_cast<u32>((128 - fractS) * fractT),
+                          static_cast<u32>(fractS * fractT)};
+  const __m128i top = WeightTexels(texels[0], weights[0], texels[1], weights[1]);
+  const __m128i bottom = WeightTexels(texels[2], weights[2], texels[3], weights[3]);
+  StoreTexel(_mm_add_epi32(top, bottom), 14, outTexel);
+#else
+  BlendTexelsScalar(texels, fractS, fractT, outTexel);
+#endif
+}
+}  // namespace TextureSampler
@@ -0,0 +1,258 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/HiresTexturePack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Common/Align.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+
+namespace
+{
+constexpr u32 PACK_MAGIC = 0x4B505444;  // "DTPK"
+constexpr u32 PACK_VERSION = 2;
+
+#pragma pack(push, 1)
+struct PackHeader
+{
+  u32 magic;
+  u32 version;
+  u32 entry_count;
+  u32 level_count;
+  u64 index_offset;
+};
+
+struct PackEntry
+{
+  u64 name_offset;
+  u32 name_length;
+  u32 flags;
+  u32 first_level;
+  u32 level_count;
+};
+
+struct PackLevel
+{
+  u32 format;
+  u32 width;
+  u32 height;
+  u32 row_length;
+  u64 offset;
+  u64 stored_size;
+  u64 size;
+};
+#pragma pack(pop)
+
+// Returns the number of bytes the texture cache reads for a level, or 0 for unsupported formats.
+u64 GetLevelSize(AbstractTextureFormat format, u32 row_length, u32 height)
+{
+  const u64 blocks_wide = std::max(Common::AlignUp(row_length, 4u) / 4, 1u);
+  const u64 blocks_high = std::max(Common::AlignUp(height, 4u) / 4, 1u);
+  switch (format)
+  {
+  case AbstractTextureFormat::RGBA8:
+    return u64(row_length) * height * 4;
+  case AbstractTextureFormat::DXT1:
+    return blocks_wide * blocks_high * 8;
+  case AbstractTextureFormat::DXT3:
+  case AbstractTextureFormat::DXT5:
+  case AbstractTextureFormat::BPTC:
+    return blocks_wide * blocks_high * 16;
+  default:
+    return 0;
+  }
+}
+}  // Anonymous namespace
+
+std::unique_ptr<HiresTexturePack> HiresTexturePack::Open(const std::string& path)
+{
+  // Can't use make_unique due to private constructor.
+  std::unique_ptr<HiresTexturePack> pack(new HiresTexturePack(path));
+  if (!pack->Map())
+  {
+    ERROR_LOG(VIDEO, "Failed to map custom texture pack %s", path.c_str());
+    return nullptr;
+  }
+
+  if (!pack->ParseIndex())
+  {
+    ERROR_LOG(VIDEO, "Custom texture pack %s is invalid", path.c_str());
+    return nullptr;
+  }
+
+  return pack;
+}
+
+HiresTexturePack::~HiresTexturePack()
+{
+#ifdef _WIN32
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping_handle)
+    CloseHandle(m_mapping_handle);
+  if (m_file_handle)
+    CloseHandle(m_file_handle);
+#else
+  if (m_data)
+    munmap(const_cast<u8*>(m_data), m_size);
+#endif
+}
+
+bool HiresTexturePack::Map()
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileW(UTF8ToUTF16(m_path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  m_file_handle = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    return false;
+  m_size = size.QuadPart;
+
+  m_mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_mapping_handle)
+    return false;
+
+  m_data = static_cast<const u8*>(MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+  return m_data != nullptr;
+#else
+  const int fd = open(m_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat file_info;
+  if (fstat(fd, &file_info) != 0 || file_info.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+  m_size = file_info.st_size;
+
+  void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file alive.
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  m_data = static_cast<const u8*>(data);
+  return true;
+#endif
+}
+
+bool HiresTexturePack::ParseIndex()
+{
+  PackHeader header;
+  if (m_size < sizeof(header))
+    return false;
+  std::memcpy(&header, m_data, sizeof(header));
+  if (header.magic != PACK_MAGIC || header.version != PACK_VERSION)
+    return false;
+
+  const u64 entries_offset = header.index_offset;
+  const u64 levels_offset = entries_offset + u64(header.entry_count) * sizeof(PackEntry);
+  const u64 index_end = levels_offset + u64(header.level_count) * sizeof(PackLevel);
+  if (entries_offset < sizeof(header) || entries_offset > m_size || index_end > m_size)
+    return false;
+
+  m_levels.reserve(header.level_count);
+  for (u32 i = 0; i < header.level_count; i++)
+  {
+    PackLevel level;
+    std::memcpy(&level, m_data + levels_offset + i * sizeof(PackLevel), sizeof(level));
+
+    const AbstractTextureFormat format = static_cast<AbstractTextureFormat>(level.format);
+    const u64 expected_size = GetLevelSize(format, level.row_length, level.height);
+    if (level.width == 0 || level.height == 0 || level.row_length < level.width ||
+        expected_size == 0 || level.size != expected_size || level.offset > m_size ||
+        level.stored_size > m_size - level.offset)
+    {
+      return false;
+    }
+
+    m_levels.push_back({format, level.width, level.height, level.row_length, level.offset,
+                        level.stored_size, level.size});
+  }
+
+  m_entries.reserve(header.entry_count);
+  for (u32 i = 0; i < header.entry_count; i++)
+  {
+    PackEntry entry;
+    std::memcpy(&entry, m_data + entries_offset + i * sizeof(PackEntry), sizeof(entry));
+
+    if (entry.name_offset > m_size || entry.name_length > m_size - entry.name_offset ||
+        entry.level_count == 0 ||
+        u64(entry.first_level) + entry.level_count > m_levels.size())
+    {
+      return false;
+    }
+
+    const AbstractTextureFormat format = m_levels[entry.first_level].format;
+    for (u32 j = 1; j < entry.level_count; j++)
+    {
+      if (m_levels[entry.first_level + j].format != format)
+        return false;
+    }
+
+    m_entries.push_back({std::string(reinterpret_cast<const char*>(m_data + entry.name_offset),
+                                     entry.name_length),
+                         format, (entry.flags & ENTRY_ARBITRARY_MIPMAPS) != 0, entry.first_level,
+                         entry.level_count});
+  }
+
+  return true;
+}
+
+bool HiresTexturePack::ReadLevels(const Entry& entry,
+                                  std::vector<HiresTexture::Level>* levels) const
+{
+  for (u32 i = 0; i < entry.level_count; i++)
+  {
+    const LevelInfo& info = m_levels[entry.first_level + i];
+
+    HiresTexture::Level level;
+    level.format = info.format;
+    level.width = info.width;
+    level.height = info.height;
+    level.row_length = info.row_length;
+    level.data.resize(info.size);
+
+    const u8* stored = m_data + info.offset;
+    if (info.stored_size == info.size)
+    {
+      std::copy(stored, stored + info.size, level.data.begin());
+    }
+    else
+    {
+      uLongf size = static_cast<uLongf>(info.size);
+      if (uncompress(level.data.data(), &size, stored, static_cast<uLong>(info.stored_size)) !=
+              Z_OK ||
+          size != info.size)
+      {
+        ERROR_LOG(VIDEO, "Custom texture %s in %s is corrupted", entry.name.c_str(),
+                  m_path.c_str());
+        return false;
+      }
+    }
+
+    levels->push_back(std::move(level));
+  }
+
+  return true;
+}
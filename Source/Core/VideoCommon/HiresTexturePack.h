@@ -0,0 +1,80 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/HiresTextures.h"
+
+// A packed custom texture set, as written by Tools/pack-hires-textures.py.
+//
+// Instead of one PNG or DDS file per texture and mip level, all textures of a game are stored in a
+// single file together with an index of their names. The mip levels are stored in the format
+// they are uploaded in (RGBA8 or one of the BCn formats), each compressed with zlib, so loading a
+// texture only means inflating it from the mapped file.
+//
+// All integers are little endian, offsets and sizes are 64-bit so packs can exceed 4 GiB. The index
+// comes last, so that the converter can write the level data as it goes:
+//   Header        magic "DTPK", version, entry count, level count, index offset
+//   level data
+//   Entry[]       name offset, name length, flags, first level, level count
+//   Level[]       format, width, height, row length, data offset, stored size, size
+//   names
+class HiresTexturePack
+{
+public:
+  enum EntryFlags : u32
+  {
+    ENTRY_ARBITRARY_MIPMAPS = 1 << 0,
+  };
+
+  struct Entry
+  {
+    std::string name;
+    // All levels of an entry share the same format.
+    AbstractTextureFormat format;
+    bool has_arbitrary_mipmaps;
+    u32 first_level;
+    u32 level_count;
+  };
+
+  static std::unique_ptr<HiresTexturePack> Open(const std::string& path);
+  ~HiresTexturePack();
+
+  const std::string& GetPath() const { return m_path; }
+  const std::vector<Entry>& GetEntries() const { return m_entries; }
+  // Can be called from any thread, the pack is not modified after it has been opened.
+  bool ReadLevels(const Entry& entry, std::vector<HiresTexture::Level>* levels) const;
+
+private:
+  struct LevelInfo
+  {
+    AbstractTextureFormat format;
+    u32 width;
+    u32 height;
+    u32 row_length;
+    u64 offset;
+    u64 stored_size;
+    u64 size;
+  };
+
+  explicit HiresTexturePack(const std::string& path) : m_path(path) {}
+  bool Map();
+  bool ParseIndex();
+
+  std::string m_path;
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+#ifdef _WIN32
+  void* m_file_handle = nullptr;
+  void* m_mapping_handle = nullptr;
+#endif
+
+  std::vector<Entry> m_entries;
+  std::vector<LevelInfo> m_levels;
+};
@@ -6,12 +6,17 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <iterator>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <xxhash.h>
@@ -23,27 +28,59 @@
 #include "Common/Hash.h"
 #include "Common/Image.h"
 #include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
 #include "Common/Thread.h"
-#include "Common/Timer.h"
-#include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
+#include "VideoCommon/HiresTexturePack.h"
 #include "VideoCommon/VideoConfig.h"
 
 struct DiskTexture
 {
   std::string path;
   bool has_arbitrary_mipmaps;
+  // Set if the texture is stored in a texture pack rather than in its own files.
+  const HiresTexturePack* pack;
+  const HiresTexturePack::Entry* pack_entry;
+};
+
+struct CachedTexture
+{
+  std::shared_ptr<HiresTexture> texture;
+  size_t size;
+  // Position in s_textureCacheLRU.
+  std::list<std::string>::iterator lru;
+};
+
+struct LoadRequest
+{
+  std::string base_filename;
+  u32 width;
+  u32 height;
 };
 
 static std::unordered_map<std::string, DiskTexture> s_textureMap;
-static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_textureCache;
+static std::vector<std::unique_ptr<HiresTexturePack>> s_texturePacks;
+static std::unordered_map<std::string, CachedTexture> s_textureCache;
+// Names of the cached textures, most recently requested first.
+static std::list<std::string> s_textureCacheLRU;
+static size_t s_textureCacheSize = 0;
+static size_t s_textureCacheBudget = 0;
 static std::mutex s_textureCacheMutex;
 static Common::Flag s_textureCacheAbortLoading;
 
-static std::thread s_prefetcher;
+// Textures are decoded by a pool of loader threads. Textures requested by the texture cache are
+// loaded most recent first, ahead of the ones queued up for prefetching. Both queues, the set of
+// textures which are queued or being loaded and the set of textures which failed to load are
+// guarded by s_textureCacheMutex.
+static std::vector<std::thread> s_loaders;
+static std::deque<LoadRequest> s_requestQueue;
+static std::deque<LoadRequest> s_prefetchQueue;
+static std::unordered_set<std::string> s_pendingTextures;
+static std::unordered_set<std::string> s_failedTextures;
+static std::condition_variable s_loadQueueChanged;
 
 static const std::string s_format_prefix = "tex1_";
 
@@ -54,40 +91,74 @@ void HiresTexture::Init()
 
 void HiresTexture::Shutdown()
 {
-  if (s_prefetcher.joinable())
+  StopLoaders();
+
+  s_textureMap.clear();
+  s_texturePacks.clear();
+  ClearCache();
+}
+
+void HiresTexture::StopLoaders()
+{
   {
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
     s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
   }
+  s_loadQueueChanged.notify_all();
+  for (std::thread& loader : s_loaders)
+    loader.join();
+  s_loaders.clear();
+
+  s_requestQueue.clear();
+  s_prefetchQueue.clear();
+  s_pendingTextures.clear();
+  s_failedTextures.clear();
+}
 
-  s_textureMap.clear();
+void HiresTexture::ClearCache()
+{
   s_textureCache.clear();
+  s_textureCacheLRU.clear();
+  s_textureCacheSize = 0;
 }
 
 void HiresTexture::Update()
 {
-  if (s_prefetcher.joinable())
-  {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
-  }
+  StopLoaders();
+
+  // The texture map refers to the packs, so both are rebuilt from scratch.
+  s_textureMap.clear();
+  s_texturePacks.clear();
 
   if (!g_ActiveConfig.bHiresTextures)
   {
-    s_textureMap.clear();
-    s_textureCache.clear();
+    ClearCache();
     return;
   }
 
   if (!g_ActiveConfig.bCacheHiresTextures)
   {
-    s_textureCache.clear();
+    ClearCache();
   }
 
   const std::string& game_id = SConfig::GetInstance().GetGameID();
   const std::string texture_directory = GetTextureDirectory(game_id);
   const std::vector<std::string> extensions{".png", ".dds"};
 
+  // Textures from packs are added first, so that single files can override them.
+  const std::vector<std::string> pack_paths =
+      Common::DoFileSearch({texture_directory}, {".dtp"}, /*recursive*/ true);
+  for (const std::string& path : pack_paths)
+  {
+    std::unique_ptr<HiresTexturePack> pack = HiresTexturePack::Open(path);
+    if (!pack)
+      continue;
+
+    for (const HiresTexturePack::Entry& entry : pack->GetEntries())
+      s_textureMap[entry.name] = {path, entry.has_arbitrary_mipmaps, pack.get(), &entry};
+    s_texturePacks.push_back(std::move(pack));
+  }
+
   const std::vector<std::string> texture_paths =
       Common::DoFileSearch({texture_directory}, extensions, /*recursive*/ true);
 
@@ -104,96 +175,119 @@ void HiresTexture::Update()
       const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
       if (has_arbitrary_mipmaps)
         filename.erase(arb_index, 4);
-      s_textureMap[filename] = {path, has_arbitrary_mipmaps};
+      s_textureMap[filename] = {path, has_arbitrary_mipmaps, nullptr, nullptr};
     }
   }
 
-  if (g_ActiveConfig.bCacheHiresTextures)
+  // remove cached but deleted textures
+  auto iter = s_textureCache.begin();
+  while (iter != s_textureCache.end())
   {
-    // remove cached but deleted textures
-    auto iter = s_textureCache.begin();
-    while (iter != s_textureCache.end())
+    if (s_textureMap.find(iter->first) == s_textureMap.end())
     {
-      if (s_textureMap.find(iter->first) == s_textureMap.end())
-      {
-        iter = s_textureCache.erase(iter);
-      }
-      else
-      {
-        iter++;
-      }
+      s_textureCacheSize -= iter->second.size;
+      s_textureCacheLRU.erase(iter->second.lru);
+      iter = s_textureCache.erase(iter);
+    }
+    else
+    {
+      iter++;
     }
-
-    s_textureCacheAbortLoading.Clear();
-    s_prefetcher = std::thread(Prefetch);
   }
-}
-
-void HiresTexture::Prefetch()
-{
-  Common::SetCurrentThreadName("Prefetcher");
 
-  size_t size_sum = 0;
   size_t sys_mem = Common::MemPhysical();
   size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
   // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
-  size_t max_mem =
+  s_textureCacheBudget =
       (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
-  u32 starttime = Common::Timer::GetTimeMs();
-  for (const auto& entry : s_textureMap)
-  {
-    const std::string& base_filename = entry.first;
 
-    if (base_filename.find("_mip") == std::string::npos)
+  if (g_ActiveConfig.bCacheHiresTextures)
+  {
+    for (const auto& entry : s_textureMap)
     {
-      std::unique_lock<std::mutex> lk(s_textureCacheMutex);
-
-      auto iter = s_textureCache.find(base_filename);
-      if (iter == s_textureCache.end())
-      {
-        // unlock while loading a texture. This may result in a race condition where
-        // we'll load a texture twice, but it reduces the stuttering a lot.
-        lk.unlock();
-        std::unique_ptr<HiresTexture> texture = Load(base_filename, 0, 0);
-        lk.lock();
-        if (texture)
-        {
-          std::shared_ptr<HiresTexture> ptr(std::move(texture));
-          iter = s_textureCache.insert(iter, std::make_pair(base_filename, ptr));
-        }
-      }
-      if (iter != s_textureCache.end())
+      const std::string& base_filename = entry.first;
+      if (base_filename.find("_mip") == std::string::npos &&
+          s_textureCache.find(base_filename) == s_textureCache.end())
       {
-        for (const Level& l : iter->second->m_levels)
-          size_sum += l.data.size();
+        s_prefetchQueue.push_back({base_filename, 0, 0});
+        s_pendingTextures.insert(base_filename);
       }
     }
+  }
+
+  s_textureCacheAbortLoading.Clear();
+  const unsigned int num_loaders =
+      MathUtil::Clamp(std::thread::hardware_concurrency() / 2, 1u, 8u);
+  for (unsigned int i = 0; i < num_loaders; ++i)
+    s_loaders.emplace_back(LoaderThread);
+}
 
+void HiresTexture::LoaderThread()
+{
+  Common::SetCurrentThreadName("Custom Texture Loader");
+
+  std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+  while (true)
+  {
+    s_loadQueueChanged.wait(lk, [] {
+      return s_textureCacheAbortLoading.IsSet() || !s_requestQueue.empty() ||
+             !s_prefetchQueue.empty();
+    });
     if (s_textureCacheAbortLoading.IsSet())
-    {
       return;
+
+    const bool prefetch = s_requestQueue.empty();
+    std::deque<LoadRequest>& queue = prefetch ? s_prefetchQueue : s_requestQueue;
+    const LoadRequest request = std::move(queue.front());
+    queue.pop_front();
+
+    // Prefetching stops at the memory budget, as the textures would only evict each other.
+    if (prefetch && s_textureCacheSize >= s_textureCacheBudget)
+    {
+      s_pendingTextures.erase(request.base_filename);
+      continue;
     }
 
-    if (size_sum > max_mem)
+    lk.unlock();
+    std::unique_ptr<HiresTexture> texture =
+        Load(request.base_filename, request.width, request.height);
+    lk.lock();
+
+    s_pendingTextures.erase(request.base_filename);
+    if (!texture)
     {
-      Config::SetCurrent(Config::GFX_HIRES_TEXTURES, false);
-
-#if 0
-      OSD::AddMessage(
-          StringFromFormat(
-              "Custom Textures prefetching after %.1f MB aborted, not enough RAM available",
-              size_sum / (1024.0 * 1024.0)),
-          10000);
-#endif
-      return;
+      s_failedTextures.insert(request.base_filename);
+      continue;
     }
+
+    size_t size = 0;
+    for (const Level& l : texture->m_levels)
+      size += l.data.size();
+    // Prefetched textures haven't been requested yet, so they are the first to go.
+    const auto lru = prefetch ?
+                         s_textureCacheLRU.insert(s_textureCacheLRU.end(), request.base_filename) :
+                         s_textureCacheLRU.insert(s_textureCacheLRU.begin(), request.base_filename);
+    s_textureCache[request.base_filename] = {std::move(texture), size, lru};
+    s_textureCacheSize += size;
+    EvictTextures(request.base_filename);
+  }
+}
+
+void HiresTexture::EvictTextures(const std::string& keep)
+{
+  // Drop the least recently requested textures until the cache fits into its budget again.
+  // Textures still in use by the texture cache stay alive through their shared pointers.
+  while (s_textureCacheSize > s_textureCacheBudget && s_textureCache.size() > 1)
+  {
+    auto oldest = std::prev(s_textureCacheLRU.end());
+    if (*oldest == keep)
+      --oldest;
+
+    auto iter = s_textureCache.find(*oldest);
+    s_textureCacheSize -= iter->second.size;
+    s_textureCache.erase(iter);
+    s_textureCacheLRU.erase(oldest);
   }
-#if 0
-  u32 stoptime = Common::Timer::GetTimeMs();
-  OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
-                                   size_sum / (1024.0 * 1024.0), (stoptime - starttime) / 1000.0),
-                  10000);
-#endif
 }
 
 std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
@@ -285,27 +379,66 @@ u32 HiresTexture::CalculateMipCount(u32 width, u32 height)
 std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t texture_size,
                                                    const u8* tlut, size_t tlut_size, u32 width,
                                                    u32 height, TextureFormat format,
-                                                   bool has_mipmaps)
+                                                   bool has_mipmaps, std::string* pending_name)
 {
   std::string base_filename =
       GenBaseName(texture, texture_size, tlut, tlut_size, width, height, format, has_mipmaps);
+  if (base_filename.empty())
+    return nullptr;
 
-  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
-
-  auto iter = s_textureCache.find(base_filename);
-  if (iter != s_textureCache.end())
   {
-    return iter->second;
-  }
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+
+    auto iter = s_textureCache.find(base_filename);
+    if (iter != s_textureCache.end())
+    {
+      std::shared_ptr<HiresTexture> hires_texture = iter->second.texture;
+      if (g_ActiveConfig.bCacheHiresTextures)
+      {
+        s_textureCacheLRU.splice(s_textureCacheLRU.begin(), s_textureCacheLRU, iter->second.lru);
+      }
+      else
+      {
+        // Without caching, textures are only kept until the requester picks them up.
+        s_textureCacheSize -= iter->second.size;
+        s_textureCacheLRU.erase(iter->second.lru);
+        s_textureCache.erase(iter);
+      }
+      return hires_texture;
+    }
 
-  std::shared_ptr<HiresTexture> ptr(Load(base_filename, width, height));
+    if (s_failedTextures.count(base_filename))
+      return nullptr;
 
-  if (ptr && g_ActiveConfig.bCacheHiresTextures)
-  {
-    s_textureCache[base_filename] = ptr;
+    // Hand the texture to the loaders. The caller uses the native texture in the meantime.
+    if (s_pendingTextures.insert(base_filename).second)
+    {
+      s_requestQueue.push_front({base_filename, width, height});
+    }
+    else
+    {
+      // Already queued for prefetching, move it to the front.
+      auto queued = std::find_if(
+          s_prefetchQueue.begin(), s_prefetchQueue.end(),
+          [&](const LoadRequest& request) { return request.base_filename == base_filename; });
+      if (queued != s_prefetchQueue.end())
+      {
+        s_requestQueue.push_front({base_filename, width, height});
+        s_prefetchQueue.erase(queued);
+      }
+    }
   }
+  s_loadQueueChanged.notify_one();
 
-  return ptr;
+  if (pending_name)
+    *pending_name = std::move(base_filename);
+  return nullptr;
+}
+
+bool HiresTexture::IsPending(const std::string& base_filename)
+{
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  return s_pendingTextures.count(base_filename) != 0;
 }
 
 std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filename, u32 width,
@@ -322,37 +455,59 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   std::unique_ptr<HiresTexture> ret = std::unique_ptr<HiresTexture>(new HiresTexture());
   const DiskTexture& first_mip_file = filename_iter->second;
   ret->m_has_arbitrary_mipmaps = first_mip_file.has_arbitrary_mipmaps;
-  LoadDDSTexture(ret.get(), first_mip_file.path);
 
-  // Load remaining mip levels, or from the start if it's not a DDS texture.
-  for (u32 mip_level = static_cast<u32>(ret->m_levels.size());; mip_level++)
+  // Packed textures come with all of their mip levels, ready for uploading.
+  if (first_mip_file.pack)
   {
-    std::string filename = base_filename;
-    if (mip_level != 0)
-      filename += StringFromFormat("_mip%u", mip_level);
-
-    filename_iter = s_textureMap.find(filename);
-    if (filename_iter == s_textureMap.end())
-      break;
-
-    // Try loading DDS textures first, that way we maintain compression of DXT formats.
-    // TODO: Reduce the number of open() calls here. We could use one fd.
-    Level level;
-    if (!LoadDDSTexture(level, filename_iter->second.path, mip_level))
+    // Unlike DDS files, packed textures can't fall back to RGBA. Check before inflating them.
+    const AbstractTextureFormat format = first_mip_file.pack_entry->format;
+    if ((format == AbstractTextureFormat::BPTC &&
+         !g_ActiveConfig.backend_info.bSupportsBPTCTextures) ||
+        (format != AbstractTextureFormat::RGBA8 && format != AbstractTextureFormat::BPTC &&
+         !g_ActiveConfig.backend_info.bSupportsST3CTextures))
     {
-      File::IOFile file;
-      file.Open(filename_iter->second.path, "rb");
-      std::vector<u8> buffer(file.GetSize());
-      file.ReadBytes(buffer.data(), file.GetSize());
+      ERROR_LOG(VIDEO, "Custom texture %s in %s uses a format not supported by the backend",
+                base_filename.c_str(), first_mip_file.path.c_str());
+      return nullptr;
+    }
 
-      if (!LoadTexture(level, buffer))
-      {
-        ERROR_LOG(VIDEO, "Custom texture %s failed to load", filename.c_str());
+    if (!first_mip_file.pack->ReadLevels(*first_mip_file.pack_entry, &ret->m_levels))
+      return nullptr;
+  }
+  else
+  {
+    LoadDDSTexture(ret.get(), first_mip_file.path);
+
+    // Load remaining mip levels, or from the start if it's not a DDS texture.
+    for (u32 mip_level = static_cast<u32>(ret->m_levels.size());; mip_level++)
+    {
+      std::string filename = base_filename;
+      if (mip_level != 0)
+        filename += StringFromFormat("_mip%u", mip_level);
+
+      filename_iter = s_textureMap.find(filename);
+      if (filename_iter == s_textureMap.end())
         break;
+
+      // Try loading DDS textures first, that way we maintain compression of DXT formats.
+      // TODO: Reduce the number of open() calls here. We could use one fd.
+      Level level;
+      if (!LoadDDSTexture(level, filename_iter->second.path, mip_level))
+      {
+        File::IOFile file;
+        file.Open(filename_iter->second.path, "rb");
+        std::vector<u8> buffer(file.GetSize());
+        file.ReadBytes(buffer.data(), file.GetSize());
+
+        if (!LoadTexture(level, buffer))
+        {
+          ERROR_LOG(VIDEO, "Custom texture %s failed to load", filename.c_str());
+          break;
+        }
       }
-    }
 
-    ret->m_levels.push_back(std::move(level));
+      ret->m_levels.push_back(std::move(level));
+    }
   }
 
   // If we failed to load any mip levels, we can't use this texture at all.
@@ -20,9 +20,14 @@ public:
   static void Update();
   static void Shutdown();
 
+  // Returns the custom texture if it has been loaded. Otherwise, the texture is queued up for
+  // loading in the background, and its name is returned through pending_name so that the caller
+  // can check back once it is no longer pending.
   static std::shared_ptr<HiresTexture> Search(const u8* texture, size_t texture_size,
                                               const u8* tlut, size_t tlut_size, u32 width,
-                                              u32 height, TextureFormat format, bool has_mipmaps);
+                                              u32 height, TextureFormat format, bool has_mipmaps,
+                                              std::string* pending_name = nullptr);
+  static bool IsPending(const std::string& base_filename);
 
   static std::string GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
                                  size_t tlut_size, u32 width, u32 height, TextureFormat format,
@@ -51,7 +56,10 @@ private:
   static bool LoadDDSTexture(HiresTexture* tex, const std::string& filename);
   static bool LoadDDSTexture(Level& level, const std::string& filename, u32 mip_level);
   static bool LoadTexture(Level& level, const std::vector<u8>& buffer);
-  static void Prefetch();
+  static void LoaderThread();
+  static void StopLoaders();
+  static void ClearCache();
+  static void EvictTextures(const std::string& keep);
 
   static std::string GetTextureDirectory(const std::string& game_id);
 
@@ -15,7 +15,12 @@
 // when they are called. The reason is that the vertex format affects the sizes of the vertices.
 
 #include "VideoCommon/OpcodeDecoding.h"
+
+#include <unordered_map>
+#include <vector>
+
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Core/HW/Memmap.h"
@@ -33,6 +38,59 @@ namespace OpcodeDecoder
 {
 static bool s_bFifoErrorSeen = false;
 
+// Most games call the same static display lists every frame. The converted vertices of their
+// draws are kept per display list address and reused as long as the list's contents hash the same.
+// Register loads are still executed on every call, as they change global state.
+struct CachedDisplayList
+{
+  u32 size = 0;
+  u64 hash = 0;
+  std::vector<VertexLoaderManager::CachedDraw> draws;
+};
+
+// Once the recorded vertices exceed this, the whole cache is dropped and rebuilt from the lists
+// which are still in use.
+constexpr size_t DISPLAY_LIST_CACHE_BUDGET = 64 * 1024 * 1024;
+
+static std::unordered_map<u32, CachedDisplayList> s_display_list_cache;
+static size_t s_display_list_cache_bytes = 0;
+static CachedDisplayList* s_current_display_list = nullptr;
+static const u8* s_current_display_list_start = nullptr;
+static size_t s_current_draw = 0;
+
+static void ForgetDraw(VertexLoaderManager::CachedDraw& draw)
+{
+  s_display_list_cache_bytes -= draw.vertices.size();
+  draw = {};
+}
+
+static VertexLoaderManager::CachedDraw* GetCachedDraw(const u8* opcode_start)
+{
+  if (!s_current_display_list)
+    return nullptr;
+
+  // The draws of a list are matched in order. If the vertex formats at the time of the call
+  // change the size of a draw, the following draws move and are recorded anew.
+  const u32 offset = static_cast<u32>(opcode_start - s_current_display_list_start);
+  std::vector<VertexLoaderManager::CachedDraw>& draws = s_current_display_list->draws;
+  if (s_current_draw == draws.size())
+    draws.emplace_back();
+
+  VertexLoaderManager::CachedDraw& draw = draws[s_current_draw++];
+  if (draw.offset != offset)
+  {
+    ForgetDraw(draw);
+    draw.offset = offset;
+  }
+  return &draw;
+}
+
+void ClearDisplayListCache()
+{
+  s_display_list_cache.clear();
+  s_display_list_cache_bytes = 0;
+}
+
 static u32 InterpretDisplayList(u32 address, u32 size)
 {
   u8* startAddress;
@@ -47,6 +105,23 @@ static u32 InterpretDisplayList(u32 address, u32 size)
   // Avoid the crash if Memory::GetPointer failed ..
   if (startAddress != nullptr)
   {
+    if (s_display_list_cache_bytes > DISPLAY_LIST_CACHE_BUDGET)
+      ClearDisplayListCache();
+
+    CachedDisplayList& list = s_display_list_cache[address];
+    const u64 hash = Common::GetHash64(startAddress, size, 0);
+    if (list.size != size || list.hash != hash)
+    {
+      for (VertexLoaderManager::CachedDraw& draw : list.draws)
+        ForgetDraw(draw);
+      list.draws.clear();
+      list.size = size;
+      list.hash = hash;
+    }
+    s_current_display_list = &list;
+    s_current_display_list_start = startAddress;
+    s_current_draw = 0;
+
     // temporarily swap dl and non-dl (small "hack" for the stats)
     Statistics::SwapDL();
 
@@ -55,6 +130,8 @@ static u32 InterpretDisplayList(u32 address, u32 size)
 
     // un-swap
     Statistics::SwapDL();
+
+    s_current_display_list = nullptr;
   }
 
   return cycles;
@@ -75,6 +152,7 @@ static void InterpretDisplayListPreprocess(u32 address, u32 size)
 void Init()
 {
   s_bFifoErrorSeen = false;
+  ClearDisplayListCache();
 }
 
 template <bool is_preprocess>
@@ -218,9 +296,20 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list)
         if (src.size() < 2)
           goto end;
         u16 num_vertices = src.Read<u16>();
+        VertexLoaderManager::CachedDraw* cached_draw = nullptr;
+        size_t cached_bytes = 0;
+        if (!is_preprocess && in_display_list)
+        {
+          cached_draw = GetCachedDraw(opcodeStart);
+          if (cached_draw)
+            cached_bytes = cached_draw->vertices.size();
+        }
         int bytes = VertexLoaderManager::RunVertices(
             cmd_byte & GX_VAT_MASK,  // Vertex loader index (0 - 7)
-            (cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT, num_vertices, src, is_preprocess);
+            (cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT, num_vertices, src, is_preprocess,
+            cached_draw);
+        if (cached_draw)
+          s_display_list_cache_bytes += cached_draw->vertices.size() - cached_bytes;
 
         if (bytes < 0)
           goto end;
@@ -52,6 +52,9 @@ enum
 
 void Init();
 
+// Drops the converted vertex data recorded for display lists.
+void ClearDisplayListCache();
+
 template <bool is_preprocess = false>
 u8* Run(DataReader src, u32* cycles, bool in_display_list);
 
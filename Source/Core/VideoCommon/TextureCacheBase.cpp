@@ -83,6 +83,7 @@ TextureCacheBase::TextureCacheBase()
   HiresTexture::Init();
 
   Common::SetHash64Function();
+  Memory::EnableWriteWatching(backup_config.texture_write_tracking);
 
   InvalidateAllBindPoints();
 }
@@ -102,6 +103,7 @@ void TextureCacheBase::Invalidate()
   }
   textures_by_address.clear();
   textures_by_hash.clear();
+  hash_memo.clear();
 
   texture_pool.clear();
 }
@@ -109,6 +111,7 @@ void TextureCacheBase::Invalidate()
 TextureCacheBase::~TextureCacheBase()
 {
   HiresTexture::Shutdown();
+  Memory::EnableWriteWatching(false);
   Invalidate();
   Common::FreeAlignedMemory(temp);
   temp = nullptr;
@@ -137,6 +140,12 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
                                        g_ActiveConfig.bTexFmtOverlayCenter);
   }
 
+  if (config.bTextureWriteTracking != backup_config.texture_write_tracking)
+  {
+    hash_memo.clear();
+    Memory::EnableWriteWatching(config.bTextureWriteTracking);
+  }
+
   if ((config.stereo_mode != StereoMode::Off) != backup_config.stereo_3d ||
       config.bStereoEFBMonoDepth != backup_config.efb_mono_depth)
   {
@@ -150,6 +159,15 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
 
 void TextureCacheBase::Cleanup(int _frameCount)
 {
+  hash_memo_frame = _frameCount;
+  for (auto iter = hash_memo.begin(); iter != hash_memo.end();)
+  {
+    if (_frameCount > TEXTURE_KILL_THRESHOLD + iter->second.frameCount)
+      iter = hash_memo.erase(iter);
+    else
+      ++iter;
+  }
+
   TexAddrCache::iterator iter = textures_by_address.begin();
   TexAddrCache::iterator tcend = textures_by_address.end();
   while (iter != tcend)
@@ -234,6 +252,24 @@ void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
   backup_config.gpu_texture_decoding = config.bEnableGPUTextureDecoding;
   backup_config.disable_vram_copies = config.bDisableCopyToVRAM;
   backup_config.arbitrary_mipmap_detection = config.bArbitraryMipmapDetection;
+  backup_config.texture_write_tracking = config.bTextureWriteTracking;
+}
+
+u64 TextureCacheBase::GetTextureHash(const u8* src, u32 size, u32 samples)
+{
+  // The pages are watched before hashing, so a write racing with the hash is never missed.
+  const u64 generation = Memory::WatchWrites(src, size);
+  if (generation == 0)
+    return Common::GetHash64(src, size, samples);
+
+  HashMemoEntry& memo = hash_memo[std::make_tuple(src, size, samples)];
+  if (memo.generation != generation)
+  {
+    memo.generation = generation;
+    memo.hash = Common::GetHash64(src, size, samples);
+  }
+  memo.frameCount = hash_memo_frame;
+  return memo.hash;
 }
 
 TextureCacheBase::TCacheEntry*
@@ -820,7 +856,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
 
   // TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data
   // from the low tmem bank than it should)
-  base_hash = Common::GetHash64(src_data, texture_size, textureCacheSafetyColorSampleSize);
+  base_hash = GetTextureHash(src_data, texture_size, textureCacheSafetyColorSampleSize);
   u32 palette_size = 0;
   if (isPaletteTexture)
   {
@@ -934,6 +970,14 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
           entry->native_levels >= tex_levels && entry->native_width == nativeW &&
           entry->native_height == nativeH)
       {
+        // Recreate the entry once its custom texture has finished loading in the background.
+        if (!entry->pending_hires_name.empty() &&
+            !HiresTexture::IsPending(entry->pending_hires_name))
+        {
+          iter = InvalidateTexture(iter);
+          continue;
+        }
+
         entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
 
         return entry;
@@ -983,7 +1027,8 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       TCacheEntry* entry = hash_iter->second;
       // All parameters, except the address, need to match here
       if (entry->format == full_format && entry->native_levels >= tex_levels &&
-          entry->native_width == nativeW && entry->native_height == nativeH)
+          entry->native_width == nativeW && entry->native_height == nativeH &&
+          entry->pending_hires_name.empty())
       {
         entry = DoPartialTextureUpdates(hash_iter->second, &texMem[tlutaddr], tlutfmt);
 
@@ -1001,10 +1046,11 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   }
 
   std::shared_ptr<HiresTexture> hires_tex;
+  std::string pending_hires_name;
   if (g_ActiveConfig.bHiresTextures)
   {
     hires_tex = HiresTexture::Search(src_data, texture_size, &texMem[tlutaddr], palette_size, width,
-                                     height, texformat, use_mipmaps);
+                                     height, texformat, use_mipmaps, &pending_hires_name);
 
     if (hires_tex)
     {
@@ -1119,6 +1165,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   entry->SetDimensions(nativeW, nativeH, tex_levels);
   entry->SetHashes(base_hash, full_hash);
   entry->is_custom_tex = hires_tex != nullptr;
+  entry->pending_hires_name = std::move(pending_hires_name);
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
 
@@ -1306,8 +1353,8 @@ std::optional<TextureLookupInformation> TextureCacheBase::ComputeTextureInformat
 
   // TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data
   // from the low tmem bank than it should)
-  tex_info.base_hash = Common::GetHash64(tex_info.src_data, tex_info.total_bytes,
-                                         tex_info.texture_cache_safety_color_sample_size);
+  tex_info.base_hash = GetTextureHash(tex_info.src_data, tex_info.total_bytes,
+                                      tex_info.texture_cache_safety_color_sample_size);
 
   tex_info.is_palette_texture = IsColorIndexed(tex_format);
 
@@ -1564,6 +1611,7 @@ TextureCacheBase::CreateNormalTexture(const TextureLookupInformation& tex_info,
   entry->SetDimensions(tex_info.native_width, tex_info.native_height, tex_info.computed_levels);
   entry->SetHashes(tex_info.base_hash, tex_info.full_hash);
   entry->is_custom_tex = false;
+  entry->pending_hires_name.clear();
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
 
@@ -1830,6 +1878,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
       }
       entry->may_have_overlapping_textures = false;
       entry->is_custom_tex = false;
+      entry->pending_hires_name.clear();
 
       CopyEFBToCacheEntry(entry, is_depth_copy, srcRect, scaleByHalf, dstFormat, isIntensity, gamma,
                           clamp_top, clamp_bottom,
@@ -2278,6 +2327,7 @@ void TextureCacheBase::TCacheEntry::SetXfbCopy(u32 stride)
   is_efb_copy = false;
   is_xfb_copy = true;
   memory_stride = stride;
+  hash_generation = 0;
 
   ASSERT_MSG(VIDEO, memory_stride >= BytesPerRow(), "Memory stride is too small");
 
@@ -2289,6 +2339,7 @@ void TextureCacheBase::TCacheEntry::SetEfbCopy(u32 stride)
   is_efb_copy = true;
   is_xfb_copy = false;
   memory_stride = stride;
+  hash_generation = 0;
 
   ASSERT_MSG(VIDEO, memory_stride >= BytesPerRow(), "Memory stride is too small");
 
@@ -2314,9 +2365,14 @@ int TextureCacheBase::TCacheEntry::HashSampleSize() const
 u64 TextureCacheBase::TCacheEntry::CalculateHash() const
 {
   u8* ptr = Memory::GetPointer(addr);
+  const u64 generation = Memory::WatchWrites(ptr, size_in_bytes);
+  if (generation != 0 && generation == hash_generation)
+    return generation_hash;
+
+  u64 result;
   if (memory_stride == BytesPerRow())
   {
-    return Common::GetHash64(ptr, size_in_bytes, HashSampleSize());
+    result = Common::GetHash64(ptr, size_in_bytes, HashSampleSize());
   }
   else
   {
@@ -2338,6 +2394,10 @@ u64 TextureCacheBase::TCacheEntry::CalculateHash() const
       temp_hash = (temp_hash * 397) ^ Common::GetHash64(ptr, BytesPerRow(), samples_per_row);
       ptr += memory_stride;
     }
-    return temp_hash;
+    result = temp_hash;
   }
+
+  hash_generation = generation;
+  generation_hash = result;
+  return result;
 }
@@ -125,6 +125,7 @@ public:
     u32 memory_stride;
     bool is_efb_copy;
     bool is_custom_tex;
+    std::string pending_hires_name;  // custom texture to switch to once it has been loaded
     bool may_have_overlapping_textures = true;
     bool tmem_only = false;           // indicates that this texture only exists in the tmem cache
     bool has_arbitrary_mips = false;  // indicates that the mips in this texture are arbitrary
@@ -157,6 +158,11 @@ public:
     u32 pending_efb_copy_height = 0;
     bool pending_efb_copy_invalidated = false;
 
+    // With texture write tracking, the memory write generation CalculateHash last hashed at.
+    // The hash only needs to be recomputed once the texture's pages have been written.
+    mutable u64 hash_generation = 0;
+    mutable u64 generation_hash = 0;
+
     explicit TCacheEntry(std::unique_ptr<AbstractTexture> tex);
 
     ~TCacheEntry();
@@ -168,6 +174,7 @@ public:
       size_in_bytes = _size;
       format = _format;
       should_force_safe_hashing = force_safe_hashing;
+      hash_generation = 0;
     }
 
     void SetDimensions(unsigned int _native_width, unsigned int _native_height,
@@ -177,6 +184,7 @@ public:
       native_height = _native_height;
       native_levels = _native_levels;
       memory_stride = _native_width;
+      hash_generation = 0;
     }
 
     void SetHashes(u64 _base_hash, u64 _hash)
@@ -324,6 +332,10 @@ private:
   void DumpTexture(TCacheEntry* entry, std::string basename, unsigned int level, bool is_arbitrary);
   void CheckTempSize(size_t required_size);
 
+  // Hashes texture data, reusing an earlier hash if write tracking shows that the data hasn't
+  // been written since.
+  u64 GetTextureHash(const u8* src, u32 size, u32 samples);
+
   TCacheEntry* AllocateCacheEntry(const TextureConfig& config);
   std::unique_ptr<AbstractTexture> AllocateTexture(const TextureConfig& config);
   TexPool::iterator FindMatchingTextureFromPool(const TextureConfig& config);
@@ -368,6 +380,16 @@ private:
   TexPool texture_pool;
   u64 last_entry_id = 0;
 
+  struct HashMemoEntry
+  {
+    u64 generation;
+    u64 hash;
+    int frameCount;
+  };
+  // Recent texture hashes, keyed by source pointer, size and sample count.
+  std::map<std::tuple<const u8*, u32, u32>, HashMemoEntry> hash_memo;
+  int hash_memo_frame = FRAMECOUNT_INVALID;
+
   // Backup configuration values
   struct BackupConfig
   {
@@ -382,6 +404,7 @@ private:
     bool gpu_texture_decoding;
     bool disable_vram_copies;
     bool arbitrary_mipmap_detection;
+    bool texture_write_tracking;
   };
   BackupConfig backup_config = {};
 
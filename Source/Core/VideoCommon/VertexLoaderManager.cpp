@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -19,6 +20,7 @@
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
@@ -59,6 +61,9 @@ void Clear()
   std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
   s_vertex_loader_map.clear();
   s_native_vertex_map.clear();
+
+  // Cached display list draws refer to the loaders that converted them.
+  OpcodeDecoder::ClearDisplayListCache();
 }
 
 void UpdateVertexArrayPointers()
@@ -248,7 +253,14 @@ static VertexLoaderBase* RefreshLoader(int vtx_attr_group, bool preprocess = fal
   return loader;
 }
 
-int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool is_preprocess)
+static bool HasIndexedAttributes(const TVtxDesc& vtx_desc)
+{
+  // The high bit of each two bit array attribute selects an 8 or 16 bit index.
+  return ((vtx_desc.Hex >> 9) & 0xAAAAAA) != 0;
+}
+
+int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool is_preprocess,
+                CachedDraw* cached_draw)
 {
   if (!count)
     return 0;
@@ -280,7 +292,31 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   DataReader dst = g_vertex_manager->PrepareForAdditionalData(
       primitive, count, loader->m_native_vtx_decl.stride, cullall);
 
-  count = loader->RunVertices(src, dst, count);
+  if (cached_draw && cached_draw->loader == loader)
+  {
+    count = cached_draw->count;
+    std::memcpy(dst.GetPointer(), cached_draw->vertices.data(), cached_draw->vertices.size());
+    std::memcpy(position_cache, cached_draw->position_cache, sizeof(position_cache));
+    std::memcpy(position_matrix_index, cached_draw->position_matrix_index,
+                sizeof(position_matrix_index));
+    loader->m_numLoadedVertices += count;
+  }
+  else
+  {
+    count = loader->RunVertices(src, dst, count);
+
+    // The zfreeze position cache is only fully rewritten by draws of at least three vertices.
+    if (cached_draw && count >= 3 && !HasIndexedAttributes(g_main_cp_state.vtx_desc))
+    {
+      const u8* vertices = dst.GetPointer();
+      cached_draw->loader = loader;
+      cached_draw->count = count;
+      cached_draw->vertices.assign(vertices, vertices + count * loader->m_native_vtx_decl.stride);
+      std::memcpy(cached_draw->position_cache, position_cache, sizeof(position_cache));
+      std::memcpy(cached_draw->position_matrix_index, position_matrix_index,
+                  sizeof(position_matrix_index));
+    }
+  }
 
   IndexGenerator::AddIndices(primitive, count);
 
@@ -7,11 +7,13 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 
 class DataReader;
 class NativeVertexFormat;
+class VertexLoaderBase;
 struct PortableVertexDeclaration;
 
 namespace VertexLoaderManager
@@ -34,8 +36,24 @@ NativeVertexFormat* GetOrCreateMatchingFormat(const PortableVertexDeclaration& d
 // offsets set to the unused attributes.
 NativeVertexFormat* GetUberVertexFormat(const PortableVertexDeclaration& decl);
 
+// Converted vertices of a single draw inside a display list, recorded so that calling the same
+// display list again can skip the vertex loader. Only draws without indexed attributes are
+// recorded, as their output depends on nothing but the raw data and the vertex loader.
+struct CachedDraw
+{
+  u32 offset = 0;
+  VertexLoaderBase* loader = nullptr;
+  int count = 0;
+  std::vector<u8> vertices;
+  float position_cache[3][4];
+  u32 position_matrix_index[4];
+};
+
 // Returns -1 if buf_size is insufficient, else the amount of bytes consumed
-int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool is_preprocess);
+// If cached_draw is given, its vertices are replayed when they were converted by the same loader,
+// otherwise it is filled in with the result of this draw where possible.
+int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool is_preprocess,
+                CachedDraw* cached_draw = nullptr);
 
 // For debugging
 std::string VertexLoadersToString();
@@ -0,0 +1,26 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include "Common/MsgHandler.h"
+
+namespace
+{
+bool TestMsgHandler(const char* caption, const char* text, bool yes_no, MsgType style)
+{
+  std::fprintf(stderr, "%s\n", text);
+  ADD_FAILURE();
+  return true;  // Ignore and continue, so that yes/no questions don't abort the test.
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  RegisterMsgAlertHandler(TestMsgHandler);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
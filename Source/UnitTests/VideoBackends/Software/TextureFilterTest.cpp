@@ -0,0 +1,87 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/TextureFilter.h"
+
+using namespace TextureSampler;
+
+namespace
+{
+// Fixed pseudo-random texels, so that failures are reproducible.
+class TexelGenerator
+{
+public:
+  void Next(u8* texel)
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      m_seed = m_seed * 1103515245 + 12345;
+      texel[i] = static_cast<u8>(m_seed >> 16);
+    }
+  }
+
+private:
+  u32 m_seed = 1;
+};
+}  // namespace
+
+TEST(TextureFilter, TrilinearMatchesScalar)
+{
+  TexelGenerator generator;
+  u8 texels[2][4];
+  for (u32 lod_fract = 0; lod_fract <= 16; lod_fract++)
+  {
+    for (int i = 0; i < 256; i++)
+    {
+      generator.Next(texels[0]);
+      generator.Next(texels[1]);
+      if (i == 0)
+        std::memset(texels, 0xFF, sizeof(texels));
+
+      std::array<u8, 4> expected, result;
+      BlendTexelsScalar(texels[0], 16 - lod_fract, texels[1], lod_fract, 4, expected.data());
+      BlendTexels(texels[0], 16 - lod_fract, texels[1], lod_fract, 4, result.data());
+      EXPECT_EQ(expected, result) << "lod fraction " << lod_fract;
+    }
+  }
+}
+
+TEST(TextureFilter, BilinearMatchesScalar)
+{
+  TexelGenerator generator;
+  u8 texels[4][4];
+  for (int fract_s = 0; fract_s <= 128; fract_s++)
+  {
+    for (int fract_t = 0; fract_t <= 128; fract_t++)
+    {
+      for (auto& texel : texels)
+        generator.Next(texel);
+      // Mix in saturated channels, which are the ones most likely to overflow.
+      std::memset(texels[fract_t & 3], fract_s & 1 ? 0xFF : 0x00, sizeof(texels[0]));
+
+      std::array<u8, 4> expected, result;
+      BlendTexelsScalar(texels, fract_s, fract_t, expected.data());
+      BlendTexels(texels, fract_s, fract_t, result.data());
+      EXPECT_EQ(expected, result) << "fractions " << fract_s << ", " << fract_t;
+    }
+  }
+}
+
+TEST(TextureFilter, BilinearFullWeightReturnsTexel)
+{
+  const u8 texels[4][4] = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}, {255, 254, 253, 252}};
+  const std::array<std::array<int, 2>, 4> corners = {{{0, 0}, {128, 0}, {0, 128}, {128, 128}}};
+  for (size_t i = 0; i < corners.size(); i++)
+  {
+    std::array<u8, 4> result;
+    BlendTexels(texels, corners[i][0], corners[i][1], result.data());
+    EXPECT_EQ(0, std::memcmp(texels[i], result.data(), result.size())) << "corner " << i;
+  }
+}
@@ -0,0 +1,235 @@
+#! /usr/bin/env python3
+
+"""
+pack-hires-textures.py <texture directory> <output.dtp>
+
+Converts a folder of custom textures (tex1_*.png / tex1_*.dds) into a single
+texture pack file, which Dolphin picks up from the game's texture directory
+instead of opening every texture file on its own.
+
+PNG files are stored as RGBA8, DXT1/DXT3/DXT5/BC7 DDS files keep their
+compressed mip chains. Every mip level is compressed with zlib. Textures which
+can't be converted (e.g. uncompressed DDS files) are listed at the end; keep
+those files next to the pack, as loose files take precedence over packed ones.
+
+Requires Pillow for reading PNG files.
+"""
+
+import os
+import re
+import struct
+import sys
+import zlib
+
+try:
+    from PIL import Image
+except ImportError:
+    Image = None
+
+PACK_MAGIC = b"DTPK"
+PACK_VERSION = 2
+PACK_HEADER_SIZE = 24
+PACK_ENTRY_FORMAT = "<Q4I"
+PACK_LEVEL_FORMAT = "<4I3Q"
+ENTRY_ARBITRARY_MIPMAPS = 1 << 0
+
+# Values of AbstractTextureFormat.
+FORMAT_RGBA8 = 0
+FORMAT_DXT1 = 2
+FORMAT_DXT3 = 3
+FORMAT_DXT5 = 4
+FORMAT_BPTC = 5
+
+DDS_HEADER_FLAGS_TEXTURE = 0x00001007
+DDS_HEADER_FLAGS_MIPMAP = 0x00020000
+DDS_HEADER_FLAGS_VOLUME = 0x00800000
+DDS_FOURCC = 0x00000004
+DDS_FORMATS = {
+    b"DXT1": (FORMAT_DXT1, 8),
+    b"DXT3": (FORMAT_DXT3, 16),
+    b"DXT5": (FORMAT_DXT5, 16),
+}
+DXGI_FORMATS = {
+    71: (FORMAT_DXT1, 8),
+    74: (FORMAT_DXT3, 16),
+    77: (FORMAT_DXT5, 16),
+    98: (FORMAT_BPTC, 16),
+}
+
+class Level(object):
+    def __init__(self, fmt, width, height, row_length, data):
+        self.fmt = fmt
+        self.width = width
+        self.height = height
+        self.row_length = row_length
+        self.data = data
+
+def calculate_mip_count(width, height):
+    count = 1
+    while width > 1 or height > 1:
+        width = max(width // 2, 1)
+        height = max(height // 2, 1)
+        count += 1
+    return count
+
+def read_dds(path, first_level_only):
+    """Returns the BCn mip levels of a DDS file, or None if it can't be packed."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < 128 or data[0:4] != b"DDS ":
+        return None
+
+    flags, height, width = struct.unpack_from("<3I", data, 8)
+    mip_count = struct.unpack_from("<I", data, 28)[0]
+    pf_flags, fourcc = struct.unpack_from("<I4s", data, 80)
+    if (flags & DDS_HEADER_FLAGS_TEXTURE) != DDS_HEADER_FLAGS_TEXTURE:
+        return None
+    if flags & DDS_HEADER_FLAGS_VOLUME or width == 0 or height == 0:
+        return None
+    if not pf_flags & DDS_FOURCC:
+        return None
+
+    offset = 128
+    if fourcc == b"DX10":
+        if len(data) < 148:
+            return None
+        dxgi_format, dimension, _, array_size = struct.unpack_from("<4I", data, 128)
+        if dimension != 3 or array_size != 1 or dxgi_format not in DXGI_FORMATS:
+            return None
+        fmt, bytes_per_block = DXGI_FORMATS[dxgi_format]
+        offset = 148
+    elif fourcc in DDS_FORMATS:
+        fmt, bytes_per_block = DDS_FORMATS[fourcc]
+    else:
+        return None
+
+    # Dolphin can't upload partial blocks for the top level.
+    if width % 4 or height % 4:
+        return None
+
+    if not flags & DDS_HEADER_FLAGS_MIPMAP:
+        mip_count = 1
+    elif mip_count == 0:
+        mip_count = calculate_mip_count(width, height)
+    if first_level_only:
+        mip_count = 1
+
+    levels = []
+    for _ in range(mip_count):
+        blocks_wide = max((width + 3) // 4, 1)
+        blocks_high = max((height + 3) // 4, 1)
+        size = blocks_wide * blocks_high * bytes_per_block
+        if offset + size > len(data):
+            break
+        levels.append(Level(fmt, width, height, blocks_wide * 4, data[offset:offset + size]))
+        offset += size
+        width = max(width // 2, 1)
+        height = max(height // 2, 1)
+    return levels or None
+
+def read_png(path):
+    if Image is None:
+        sys.exit("Pillow is required to read PNG files.")
+    try:
+        image = Image.open(path).convert("RGBA")
+    except (IOError, OSError):
+        return None
+    return Level(FORMAT_RGBA8, image.width, image.height, image.width, image.tobytes())
+
+def load_texture(textures, base_name):
+    """Mirrors HiresTexture::Load: a DDS mip chain, followed by any _mipN files."""
+    levels = []
+    path = textures[base_name][0]
+    if path.lower().endswith(".dds"):
+        levels = read_dds(path, False) or []
+
+    mip_level = len(levels)
+    while True:
+        name = base_name if mip_level == 0 else "%s_mip%d" % (base_name, mip_level)
+        if name not in textures:
+            break
+        path = textures[name][0]
+        if path.lower().endswith(".dds"):
+            level = read_dds(path, True)
+            level = level[0] if level else None
+        else:
+            level = read_png(path)
+        if level is None:
+            break
+        levels.append(level)
+        mip_level += 1
+
+    if not levels or any(level.fmt != levels[0].fmt for level in levels):
+        return None
+    return levels
+
+def find_textures(directory):
+    textures = {}
+    for root, _, files in os.walk(directory):
+        for filename in files:
+            name, extension = os.path.splitext(filename)
+            if extension.lower() not in (".png", ".dds") or not name.startswith("tex1_"):
+                continue
+            arb_index = name.rfind("_arb")
+            if arb_index != -1:
+                name = name[:arb_index] + name[arb_index + 4:]
+            textures[name] = (os.path.join(root, filename), arb_index != -1)
+    return textures
+
+def write_pack(output, textures):
+    """Writes the level data as the textures are converted, followed by the index."""
+    entries = []
+    level_records = []
+    skipped = []
+    with open(output, "wb") as f:
+        f.write(b"\0" * PACK_HEADER_SIZE)
+        for base_name in sorted(textures):
+            if re.search(r"_mip\d+$", base_name):
+                continue
+            levels = load_texture(textures, base_name)
+            if levels is None:
+                skipped.append(textures[base_name][0])
+                continue
+
+            entries.append((base_name, textures[base_name][1], len(level_records), len(levels)))
+            for level in levels:
+                stored = zlib.compress(level.data, 9)
+                if len(stored) >= len(level.data):
+                    stored = level.data
+                level_records.append(struct.pack(PACK_LEVEL_FORMAT, level.fmt, level.width,
+                                                 level.height, level.row_length, f.tell(),
+                                                 len(stored), len(level.data)))
+                f.write(stored)
+
+        index_offset = f.tell()
+        names_offset = (index_offset + len(entries) * struct.calcsize(PACK_ENTRY_FORMAT) +
+                        len(level_records) * struct.calcsize(PACK_LEVEL_FORMAT))
+        for name, arbitrary_mipmaps, first_level, level_count in entries:
+            flags = ENTRY_ARBITRARY_MIPMAPS if arbitrary_mipmaps else 0
+            f.write(struct.pack(PACK_ENTRY_FORMAT, names_offset, len(name), flags, first_level,
+                                level_count))
+            names_offset += len(name)
+        for record in level_records:
+            f.write(record)
+        for name, _, _, _ in entries:
+            f.write(name.encode("ascii"))
+
+        f.seek(0)
+        f.write(PACK_MAGIC + struct.pack("<3IQ", PACK_VERSION, len(entries), len(level_records),
+                                         index_offset))
+    return len(entries), skipped
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip())
+        return 1
+    packed, skipped = write_pack(sys.argv[2], find_textures(sys.argv[1]))
+    print("Packed %d textures into %s." % (packed, sys.argv[2]))
+    if skipped:
+        print("Keep these files next to the pack, they could not be converted:")
+        for path in skipped:
+            print("  " + path)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())